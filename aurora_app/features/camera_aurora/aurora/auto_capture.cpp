@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/auto_capture.h>
+
+void AutoCapture::Configure(const Options &options)
+{
+    m_options = options;
+    m_stable = 0;
+    m_armed = true;
+}
+
+bool AutoCapture::IsEnabled() const
+{
+    return m_options.enabled;
+}
+
+bool AutoCapture::Check(const SheetAnalyzer::Sheet &sheet)
+{
+    if (!m_options.enabled) {
+        return false;
+    }
+
+    if (!sheet.found) {
+        m_stable = 0;
+        m_armed = true;
+        return false;
+    }
+
+    auto framed = IsInside(sheet.corners)
+                  && sheet.tilt <= m_options.maxTilt
+                  && sheet.jitter <= m_options.maxJitter;
+
+    m_stable = framed ? m_stable + 1 : 0;
+
+    // Blur does not break the run, the hand may steady in a moment
+    if (!m_armed || m_stable < m_options.stableFrames || sheet.sharpness < m_options.minSharpness) {
+        return false;
+    }
+
+    m_armed = false;
+    return true;
+}
+
+bool AutoCapture::IsInside(const omr::Quad &corners) const
+{
+    auto low = m_options.margin;
+    auto high = 1 - m_options.margin;
+
+    for (const auto &corner : corners) {
+        if (corner.x < low || corner.x > high || corner.y < low || corner.y > high) {
+            return false;
+        }
+    }
+    return true;
+}
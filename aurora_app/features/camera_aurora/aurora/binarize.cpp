@@ -0,0 +1,429 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/binarize.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace binarize {
+
+namespace {
+
+// Pixels of one vector step of the kernels below
+constexpr int IntegralStep = 16;
+constexpr int ThresholdStep = 8;
+
+// Integral row: `current` is `above` plus the running sum of `row`
+// started at `carry`. Returns the sum at the end of the row.
+uint32_t IntegralRowScalar(const uint8_t *row, const uint32_t *above, uint32_t *current, int width, uint32_t carry)
+{
+    for (int x = 0; x < width; x++) {
+        carry += row[x];
+        current[x] = above[x] + carry;
+    }
+    return carry;
+}
+
+// Adaptive threshold of pixels [begin, end) of a row, `top` and
+// `bottom` are the integral rows bounding the window vertically
+void ThresholdRowScalar(const uint8_t *row,
+                        const uint32_t *top,
+                        const uint32_t *bottom,
+                        uint8_t *out,
+                        int begin,
+                        int end,
+                        int width,
+                        int radius,
+                        int rows,
+                        int c,
+                        uint8_t ink,
+                        uint8_t paper)
+{
+    for (int x = begin; x < end; x++) {
+        auto x0 = std::max(0, x - radius);
+        auto x1 = std::min(width, x + radius + 1);
+        auto area = static_cast<int64_t>(x1 - x0) * rows;
+        // The integral may wrap on large planes, the box sum does not:
+        // subtracted modulo 2^32 first, widened after
+        auto sum = static_cast<int64_t>(static_cast<uint32_t>(bottom[x1] - bottom[x0] - top[x1] + top[x0]));
+        // row[x] < mean - c, without the division
+        out[x] = (row[x] + c) * area < sum ? ink : paper;
+    }
+}
+
+#if defined(__SSE2__)
+
+// Running sums of 16 bytes: widened to 16 bits, summed in the register
+// by shifted adds, widened to 32 bits and added to the row above
+uint32_t IntegralRow(const uint8_t *row, const uint32_t *above, uint32_t *current, int width, uint32_t carry)
+{
+    auto zero = _mm_setzero_si128();
+    int x = 0;
+
+    for (; x + IntegralStep <= width; x += IntegralStep) {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+        auto lo = _mm_unpacklo_epi8(bytes, zero);
+        auto hi = _mm_unpackhi_epi8(bytes, zero);
+
+        lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 2));
+        lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 4));
+        lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 2));
+        hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 4));
+        hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 8));
+        hi = _mm_add_epi16(hi, _mm_set1_epi16(static_cast<int16_t>(_mm_extract_epi16(lo, 7))));
+
+        auto base = _mm_set1_epi32(static_cast<int32_t>(carry));
+        __m128i sums[4] = {
+            _mm_unpacklo_epi16(lo, zero),
+            _mm_unpackhi_epi16(lo, zero),
+            _mm_unpacklo_epi16(hi, zero),
+            _mm_unpackhi_epi16(hi, zero),
+        };
+
+        for (int i = 0; i < 4; i++) {
+            auto prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(above + x + i * 4));
+            auto sum = _mm_add_epi32(_mm_add_epi32(sums[i], base), prev);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(current + x + i * 4), sum);
+        }
+
+        carry += static_cast<uint32_t>(_mm_extract_epi16(hi, 7));
+    }
+
+    return IntegralRowScalar(row + x, above + x, current + x, width - x, carry);
+}
+
+// 8 pixels whose window is inside the row: box sums of 32 bits against
+// (value + c) * area, multiplied as 16 x 16 -> 32 bits
+void ThresholdRow(const uint8_t *row,
+                  const uint32_t *top,
+                  const uint32_t *bottom,
+                  uint8_t *out,
+                  int begin,
+                  int end,
+                  int width,
+                  int radius,
+                  int rows,
+                  int c,
+                  bool invert)
+{
+    auto area = (2 * radius + 1) * rows;
+    auto zero = _mm_setzero_si128();
+    auto areas = _mm_set1_epi16(static_cast<int16_t>(area));
+    auto offset = _mm_set1_epi16(static_cast<int16_t>(c));
+    int x = begin;
+
+    for (; x + ThresholdStep <= end; x += ThresholdStep) {
+        auto x0 = x - radius;
+        auto x1 = x + radius + 1;
+
+        __m128i sums[2];
+        for (int i = 0; i < 2; i++) {
+            auto br = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x1 + i * 4));
+            auto bl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x0 + i * 4));
+            auto tr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x1 + i * 4));
+            auto tl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x0 + i * 4));
+            sums[i] = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(br, bl), tr), tl);
+        }
+
+        auto values = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + x)), zero);
+        values = _mm_add_epi16(values, offset);
+        auto low = _mm_mullo_epi16(values, areas);
+        auto high = _mm_mulhi_epi16(values, areas);
+
+        auto inkLo = _mm_cmplt_epi32(_mm_unpacklo_epi16(low, high), sums[0]);
+        auto inkHi = _mm_cmplt_epi32(_mm_unpackhi_epi16(low, high), sums[1]);
+        auto mask = _mm_packs_epi16(_mm_packs_epi32(inkLo, inkHi), zero);
+
+        // Ink is 0 unless inverted
+        auto bytes = invert ? mask : _mm_xor_si128(mask, _mm_set1_epi8(-1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + x), bytes);
+    }
+
+    auto ink = static_cast<uint8_t>(invert ? 255 : 0);
+    ThresholdRowScalar(row, top, bottom, out, x, end, width, radius, rows, c, ink, 255 - ink);
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+// Running sums of 16 bytes: widened to 16 bits, summed in the register
+// by shifted adds, widened to 32 bits and added to the row above
+uint32_t IntegralRow(const uint8_t *row, const uint32_t *above, uint32_t *current, int width, uint32_t carry)
+{
+    auto zero = vdupq_n_u16(0);
+    int x = 0;
+
+    for (; x + IntegralStep <= width; x += IntegralStep) {
+        auto bytes = vld1q_u8(row + x);
+        auto lo = vmovl_u8(vget_low_u8(bytes));
+        auto hi = vmovl_u8(vget_high_u8(bytes));
+
+        lo = vaddq_u16(lo, vextq_u16(zero, lo, 7));
+        lo = vaddq_u16(lo, vextq_u16(zero, lo, 6));
+        lo = vaddq_u16(lo, vextq_u16(zero, lo, 4));
+        hi = vaddq_u16(hi, vextq_u16(zero, hi, 7));
+        hi = vaddq_u16(hi, vextq_u16(zero, hi, 6));
+        hi = vaddq_u16(hi, vextq_u16(zero, hi, 4));
+        hi = vaddq_u16(hi, vdupq_n_u16(vgetq_lane_u16(lo, 7)));
+
+        auto base = vdupq_n_u32(carry);
+        uint32x4_t sums[4] = {
+            vmovl_u16(vget_low_u16(lo)),
+            vmovl_u16(vget_high_u16(lo)),
+            vmovl_u16(vget_low_u16(hi)),
+            vmovl_u16(vget_high_u16(hi)),
+        };
+
+        for (int i = 0; i < 4; i++) {
+            auto prev = vld1q_u32(above + x + i * 4);
+            vst1q_u32(current + x + i * 4, vaddq_u32(vaddq_u32(sums[i], base), prev));
+        }
+
+        carry += vgetq_lane_u16(hi, 7);
+    }
+
+    return IntegralRowScalar(row + x, above + x, current + x, width - x, carry);
+}
+
+// 8 pixels whose window is inside the row: box sums of 32 bits against
+// (value + c) * area
+void ThresholdRow(const uint8_t *row,
+                  const uint32_t *top,
+                  const uint32_t *bottom,
+                  uint8_t *out,
+                  int begin,
+                  int end,
+                  int width,
+                  int radius,
+                  int rows,
+                  int c,
+                  bool invert)
+{
+    auto area = (2 * radius + 1) * rows;
+    auto areas = vdupq_n_s32(area);
+    auto offset = vdupq_n_s16(static_cast<int16_t>(c));
+    int x = begin;
+
+    for (; x + ThresholdStep <= end; x += ThresholdStep) {
+        auto x0 = x - radius;
+        auto x1 = x + radius + 1;
+
+        int32x4_t sums[2];
+        for (int i = 0; i < 2; i++) {
+            auto box = vaddq_u32(vsubq_u32(vsubq_u32(vld1q_u32(bottom + x1 + i * 4),
+                                                     vld1q_u32(bottom + x0 + i * 4)),
+                                           vld1q_u32(top + x1 + i * 4)),
+                                 vld1q_u32(top + x0 + i * 4));
+            sums[i] = vreinterpretq_s32_u32(box);
+        }
+
+        auto values = vaddq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row + x))), offset);
+        auto inkLo = vcltq_s32(vmulq_s32(vmovl_s16(vget_low_s16(values)), areas), sums[0]);
+        auto inkHi = vcltq_s32(vmulq_s32(vmovl_s16(vget_high_s16(values)), areas), sums[1]);
+        auto mask = vmovn_u16(vcombine_u16(vmovn_u32(inkLo), vmovn_u32(inkHi)));
+
+        // Ink is 0 unless inverted
+        vst1_u8(out + x, invert ? mask : vmvn_u8(mask));
+    }
+
+    auto ink = static_cast<uint8_t>(invert ? 255 : 0);
+    ThresholdRowScalar(row, top, bottom, out, x, end, width, radius, rows, c, ink, 255 - ink);
+}
+
+#endif
+
+} // namespace
+
+Histogram MakeHistogram(const uint8_t *src, int stride, int width, int height)
+{
+    // Neither SSE2 nor NEON can scatter: four tables instead, so that
+    // runs of equal pixels do not wait on one counter
+    std::array<Histogram, 4> tables{};
+
+    for (int y = 0; y < height; y++) {
+        auto row = src + static_cast<ptrdiff_t>(y) * stride;
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            tables[0][row[x]]++;
+            tables[1][row[x + 1]]++;
+            tables[2][row[x + 2]]++;
+            tables[3][row[x + 3]]++;
+        }
+        for (; x < width; x++) {
+            tables[0][row[x]]++;
+        }
+    }
+
+    Histogram histogram;
+    for (int value = 0; value < 256; value++) {
+        histogram[value] = tables[0][value] + tables[1][value] + tables[2][value] + tables[3][value];
+    }
+
+    return histogram;
+}
+
+int Otsu(const Histogram &histogram)
+{
+    uint64_t total = 0;
+    double sum = 0;
+    for (int value = 0; value < 256; value++) {
+        total += histogram[value];
+        sum += static_cast<double>(value) * histogram[value];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t below = 0;
+    double sumBelow = 0;
+    double best = -1;
+    int threshold = 0;
+
+    for (int value = 0; value < 256; value++) {
+        below += histogram[value];
+        sumBelow += static_cast<double>(value) * histogram[value];
+
+        auto above = total - below;
+        if (below == 0 || above == 0) {
+            continue;
+        }
+
+        auto meanBelow = sumBelow / below;
+        auto meanAbove = (sum - sumBelow) / above;
+        auto variance = static_cast<double>(below) * above * (meanBelow - meanAbove) * (meanBelow - meanAbove);
+
+        if (variance > best) {
+            best = variance;
+            threshold = value;
+        }
+    }
+
+    return threshold;
+}
+
+void AdaptiveThreshold(const uint8_t *src,
+                       int srcStride,
+                       uint8_t *dst,
+                       int dstStride,
+                       int width,
+                       int height,
+                       int window,
+                       int c,
+                       bool invert)
+{
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Summed-area table with a zero first row and column
+    auto stride = static_cast<size_t>(width) + 1;
+    std::vector<uint32_t> integral(stride * (height + 1), 0);
+
+    for (int y = 0; y < height; y++) {
+        auto above = integral.data() + y * stride;
+        IntegralRow(src + static_cast<ptrdiff_t>(y) * srcStride, above + 1, above + stride + 1, width, 0);
+    }
+
+    auto radius = std::max(1, window / 2);
+    uint8_t ink = invert ? 255 : 0;
+    uint8_t paper = invert ? 0 : 255;
+
+    // The vector products are 16 x 16 bits: value + c and the area
+    auto vector = (2 * radius + 1) * static_cast<int64_t>(2 * radius + 1) <= std::numeric_limits<int16_t>::max()
+                  && c > -256 && c < 256;
+
+    // Pixels whose window is cut by the left or right edge
+    auto begin = std::min(width, radius);
+    auto end = std::max(begin, width - radius - 1);
+
+    for (int y = 0; y < height; y++) {
+        auto y0 = std::max(0, y - radius);
+        auto y1 = std::min(height, y + radius + 1);
+        auto top = integral.data() + y0 * stride;
+        auto bottom = integral.data() + y1 * stride;
+        auto row = src + static_cast<ptrdiff_t>(y) * srcStride;
+        auto out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+
+        if (!vector) {
+            ThresholdRowScalar(row, top, bottom, out, 0, width, width, radius, y1 - y0, c, ink, paper);
+            continue;
+        }
+
+        ThresholdRowScalar(row, top, bottom, out, 0, begin, width, radius, y1 - y0, c, ink, paper);
+        ThresholdRow(row, top, bottom, out, begin, end, width, radius, y1 - y0, c, invert);
+        ThresholdRowScalar(row, top, bottom, out, end, width, width, radius, y1 - y0, c, ink, paper);
+    }
+#else
+    scalar::AdaptiveThreshold(src, srcStride, dst, dstStride, width, height, window, c, invert);
+#endif
+}
+
+namespace scalar {
+
+Histogram MakeHistogram(const uint8_t *src, int stride, int width, int height)
+{
+    Histogram histogram{};
+
+    for (int y = 0; y < height; y++) {
+        auto row = src + static_cast<ptrdiff_t>(y) * stride;
+        for (int x = 0; x < width; x++) {
+            histogram[row[x]]++;
+        }
+    }
+
+    return histogram;
+}
+
+void AdaptiveThreshold(const uint8_t *src,
+                       int srcStride,
+                       uint8_t *dst,
+                       int dstStride,
+                       int width,
+                       int height,
+                       int window,
+                       int c,
+                       bool invert)
+{
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Summed-area table with a zero first row and column
+    auto stride = static_cast<size_t>(width) + 1;
+    std::vector<uint32_t> integral(stride * (height + 1), 0);
+
+    for (int y = 0; y < height; y++) {
+        auto above = integral.data() + y * stride;
+        IntegralRowScalar(src + static_cast<ptrdiff_t>(y) * srcStride, above + 1, above + stride + 1, width, 0);
+    }
+
+    auto radius = std::max(1, window / 2);
+    uint8_t ink = invert ? 255 : 0;
+    uint8_t paper = invert ? 0 : 255;
+
+    for (int y = 0; y < height; y++) {
+        auto y0 = std::max(0, y - radius);
+        auto y1 = std::min(height, y + radius + 1);
+        ThresholdRowScalar(src + static_cast<ptrdiff_t>(y) * srcStride,
+                           integral.data() + y0 * stride,
+                           integral.data() + y1 * stride,
+                           dst + static_cast<ptrdiff_t>(y) * dstStride,
+                           0, width, width, radius, y1 - y0, c, ink, paper);
+    }
+}
+
+} // namespace scalar
+
+} // namespace binarize
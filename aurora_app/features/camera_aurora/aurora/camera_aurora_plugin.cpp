@@ -8,6 +8,7 @@
 #include <QCamera>
 #include <QCameraImageCapture>
 #include <QCameraInfo>
+#include <QCoreApplication>
 #include <QMediaRecorder>
 #include <QtCore>
 
@@ -15,6 +16,10 @@ namespace Channels {
     constexpr auto Methods = "camera_aurora";
     constexpr auto StateChanged = "cameraAuroraStateChanged";
     constexpr auto QrChanged = "cameraAuroraQrChanged";
+    constexpr auto CaptureResults = "cameraAuroraCaptureResults";
+    constexpr auto ImageStream = "cameraAuroraImageStream";
+    constexpr auto Stats = "cameraAuroraStats";
+    constexpr auto Sheet = "cameraAuroraSheet";
 } // namespace Channels
 
 namespace Methods {
@@ -25,8 +30,50 @@ namespace Methods {
     constexpr auto StartCapture = "startCapture";
     constexpr auto StopCapture = "stopCapture";
     constexpr auto TakePicture = "takePicture";
+    constexpr auto PreCapture = "preCapture";
+    constexpr auto TakeBurst = "takeBurst";
+    constexpr auto SetOutput = "setOutput";
+    constexpr auto SetStateWindow = "setStateWindow";
+    constexpr auto StartImageStream = "startImageStream";
+    constexpr auto StopImageStream = "stopImageStream";
+    constexpr auto ReleaseFrame = "releaseFrame";
+    constexpr auto SetStatsInterval = "setStatsInterval";
+    constexpr auto StartTrace = "startTrace";
+    constexpr auto StopTrace = "stopTrace";
+    constexpr auto DumpTrace = "dumpTrace";
+    constexpr auto GradeSheet = "gradeSheet";
+    constexpr auto RegisterSheetLayout = "registerSheetLayout";
+    constexpr auto SetAutoCapture = "setAutoCapture";
 } // namespace Methods
 
+// State changes within the window are sent as one delta, about one vsync
+constexpr int StateWindow = 16;
+
+// Pipeline statistics are sent once a second by default
+constexpr int StatsInterval = 1000;
+
+// Preview conversion time per second for all the cameras together
+constexpr std::chrono::milliseconds PreviewBudget(500);
+
+// Threads for the blocking camera calls, shared by the cameras
+constexpr size_t CameraWorkers = 2;
+
+// Carries a task to the thread of the plugin object
+class TaskEvent : public QEvent
+{
+public:
+    static const QEvent::Type EventType;
+
+    explicit TaskEvent(const std::function<void()> &task)
+        : QEvent(EventType)
+        , task(task)
+    {}
+
+    std::function<void()> task;
+};
+
+const QEvent::Type TaskEvent::EventType = static_cast<QEvent::Type>(QEvent::registerEventType());
+
 void CameraAuroraPlugin::RegisterWithRegistrar(PluginRegistrar* registrar)
 {
     // Create MethodChannel with StandardMethodCodec
@@ -44,12 +91,36 @@ void CameraAuroraPlugin::RegisterWithRegistrar(PluginRegistrar* registrar)
         registrar->messenger(), Channels::QrChanged,
         &flutter::StandardMethodCodec::GetInstance());
 
+    // Create EventChannel with StandardMethodCodec for capture results
+    auto eventChannelCapture = std::make_unique<EventChannel>(
+        registrar->messenger(), Channels::CaptureResults,
+        &flutter::StandardMethodCodec::GetInstance());
+
+    // Create EventChannel with StandardMethodCodec for image stream
+    auto eventChannelImage = std::make_unique<EventChannel>(
+        registrar->messenger(), Channels::ImageStream,
+        &flutter::StandardMethodCodec::GetInstance());
+
+    // Create EventChannel with StandardMethodCodec for statistics
+    auto eventChannelStats = std::make_unique<EventChannel>(
+        registrar->messenger(), Channels::Stats,
+        &flutter::StandardMethodCodec::GetInstance());
+
+    // Create EventChannel with StandardMethodCodec for sheet detection
+    auto eventChannelSheet = std::make_unique<EventChannel>(
+        registrar->messenger(), Channels::Sheet,
+        &flutter::StandardMethodCodec::GetInstance());
+
     // Create plugin
     std::unique_ptr<CameraAuroraPlugin> plugin(new CameraAuroraPlugin(
         registrar,
         std::move(methodChannel),
         std::move(eventChannelChange),
-        std::move(eventChannelQr)
+        std::move(eventChannelQr),
+        std::move(eventChannelCapture),
+        std::move(eventChannelImage),
+        std::move(eventChannelStats),
+        std::move(eventChannelSheet)
     ));
 
     // Register plugin
@@ -60,28 +131,36 @@ CameraAuroraPlugin::CameraAuroraPlugin(
     PluginRegistrar* registrar,
     std::unique_ptr<MethodChannel> methodChannel,
     std::unique_ptr<EventChannel> eventChannelChange,
-    std::unique_ptr<EventChannel> eventChannelQr
-) : m_methodChannel(std::move(methodChannel)),
+    std::unique_ptr<EventChannel> eventChannelQr,
+    std::unique_ptr<EventChannel> eventChannelCapture,
+    std::unique_ptr<EventChannel> eventChannelImage,
+    std::unique_ptr<EventChannel> eventChannelStats,
+    std::unique_ptr<EventChannel> eventChannelSheet
+) : m_textures(registrar->texture_registrar()),
+    m_budget(PreviewBudget),
+    m_pool(std::make_unique<ThreadPool>()),
+    m_worker(std::make_unique<ThreadPool>(CameraWorkers)),
+    m_methodChannel(std::move(methodChannel)),
     m_eventChannelChange(std::move(eventChannelChange)),
-    m_eventChannelQr(std::move(eventChannelQr))
+    m_eventChannelQr(std::move(eventChannelQr)),
+    m_eventChannelCapture(std::move(eventChannelCapture)),
+    m_eventChannelImage(std::move(eventChannelImage)),
+    m_eventChannelStats(std::move(eventChannelStats)),
+    m_eventChannelSheet(std::move(eventChannelSheet))
 {
-    // Create camera streamcamera
-    m_textureCamera = std::make_unique<TextureCamera>(registrar->texture_registrar(),
-        [&]() {
-            if (m_stateEventChannelChange) {
-                m_sinkChange->Success(m_textureCamera->GetState());
-            }
-        },
-        [&](std::string data) {
-            if (m_stateEventChannelQr) {
-                m_sinkQr->Success(data);
-            }
-        });
+    // Coalesce state events
+    m_stateTimer.setSingleShot(true);
+    m_stateTimer.setInterval(StateWindow);
+    QObject::connect(&m_stateTimer, &QTimer::timeout, this, [this] { FlushState(); });
+
+    // Pipeline statistics, measured only while listened to
+    m_statsTimer.setInterval(StatsInterval);
+    QObject::connect(&m_statsTimer, &QTimer::timeout, this, [this] { SendStats(); });
 
     // Listen change orientation
     aurora::SubscribeOrientationChanged([&](aurora::DisplayOrientation) {
-        if (m_stateEventChannelChange) {
-            m_sinkChange->Success(m_textureCamera->GetState());
+        for (const auto &item : m_cameras) {
+            SendState(item.first, item.second.camera->GetState());
         }
     });
 
@@ -92,36 +171,183 @@ CameraAuroraPlugin::CameraAuroraPlugin(
     RegisterStreamHandler();
 }
 
+std::shared_ptr<TextureCamera> CameraAuroraPlugin::MakeCamera()
+{
+    auto camera = std::make_shared<TextureCamera>(m_textures,
+        m_pool.get(),
+        &m_budget,
+        [this](int64_t cameraId) {
+            PostToPlatform([this, cameraId] {
+                if (auto camera = Find(cameraId)) {
+                    SendState(cameraId, camera->camera->GetState());
+                }
+            });
+        },
+        [this](int64_t cameraId, std::string data) {
+            PostToPlatform([this, cameraId, data] {
+                if (m_stateEventChannelQr) {
+                    m_sinkQr->Success(EncodableMap{
+                        {"cameraId", cameraId},
+                        {"text", data},
+                    });
+                }
+            });
+        },
+        [this](int64_t cameraId, const CaptureTimeline &timeline, std::string base64) {
+            PostToPlatform([this, cameraId, timeline = timeline, base64]() mutable {
+                if (m_stateEventChannelCapture) {
+                    timeline.Mark("delivered");
+                    m_sinkCapture->Success(EncodableMap{
+                        {"cameraId", cameraId},
+                        {"captureId", timeline.CaptureId()},
+                        {"image", base64},
+                        {"timings", timeline.Stages()},
+                    });
+                }
+            });
+        },
+        [this](int64_t cameraId, const FrameStream::Frame &frame) {
+            // Dart maps the slot by its address, no pixels are copied
+            EncodableMap event{
+                {"cameraId", cameraId},
+                {"slot", frame.slot},
+                {"sequence", frame.sequence},
+                {"address", static_cast<int64_t>(reinterpret_cast<intptr_t>(frame.data))},
+                {"size", static_cast<int64_t>(frame.size)},
+                {"format", frame.format == FrameStream::Format::I420 ? "i420" : "y"},
+                {"width", frame.width},
+                {"height", frame.height},
+                {"strideY", frame.strideY},
+                {"strideUV", frame.strideUV},
+                {"offsetU", static_cast<int64_t>(frame.u ? frame.u - frame.data : 0)},
+                {"offsetV", static_cast<int64_t>(frame.v ? frame.v - frame.data : 0)},
+                {"dropped", static_cast<int64_t>(frame.dropped)},
+            };
+            auto slot = frame.slot;
+            auto sequence = frame.sequence;
+            PostToPlatform([this, cameraId, slot, sequence, event] {
+                auto camera = Find(cameraId);
+                if (!camera) {
+                    ReleaseFrame(cameraId, slot, sequence);
+                } else if (m_stateEventChannelImage && camera->camera->IsImageStream()) {
+                    m_sinkImage->Success(event);
+                } else {
+                    // Stopped meanwhile, nobody waits for the frame
+                    camera->camera->ReleaseFrame(slot, sequence);
+                }
+            });
+        });
+
+    camera->EnableSearchQr(m_stateEventChannelQr);
+    camera->Stats()->SetEnabled(m_stateEventChannelStats);
+    camera->SetSheetHandler(m_stateEventChannelSheet ? MakeSheetHandler() : nullptr);
+
+    return camera;
+}
+
+SheetHandler CameraAuroraPlugin::MakeSheetHandler()
+{
+    return [this](int64_t cameraId, const SheetAnalyzer::Sheet &sheet) {
+        EncodableList corners;
+        if (sheet.found) {
+            for (const auto &corner : sheet.corners) {
+                corners.push_back(static_cast<double>(corner.x));
+                corners.push_back(static_cast<double>(corner.y));
+            }
+        }
+
+        EncodableMap event{
+            {"cameraId", cameraId},
+            {"sequence", sheet.sequence},
+            {"found", sheet.found},
+            {"corners", corners},
+            {"jitter", static_cast<double>(sheet.jitter)},
+            {"stability", static_cast<double>(sheet.stability)},
+            {"tilt", static_cast<double>(sheet.tilt)},
+            {"sharpness", sheet.sharpness},
+        };
+
+        PostToPlatform([this, event] {
+            if (m_stateEventChannelSheet) {
+                m_sinkSheet->Success(event);
+            }
+        });
+    };
+}
+
+CameraAuroraPlugin::Camera *CameraAuroraPlugin::Find(int64_t cameraId)
+{
+    auto item = m_cameras.find(cameraId);
+    return item == m_cameras.end() ? nullptr : &item->second;
+}
+
+CameraAuroraPlugin::Camera *CameraAuroraPlugin::Route(int64_t cameraId)
+{
+    // Calls without an ID go to the only open camera
+    if (cameraId <= 0 && m_cameras.size() == 1) {
+        return &m_cameras.begin()->second;
+    }
+    return Find(cameraId);
+}
+
+void CameraAuroraPlugin::UpdateBudget()
+{
+    m_budget.SetCameras(static_cast<int>(m_cameras.size()));
+}
+
+template<typename T,
+         void (CameraAuroraPlugin::*Handler)(const T &, std::unique_ptr<MethodResult>)>
+void CameraAuroraPlugin::Dispatch(const MethodCall& call, std::unique_ptr<MethodResult> result)
+{
+    T args;
+    if (!Args::Decode(call.arguments(), args)) {
+        result->Success();
+        return;
+    }
+    (this->*Handler)(args, std::move(result));
+}
+
 void CameraAuroraPlugin::RegisterMethodHandler()
 {
+    static const std::pair<const char *, MethodHandler> methods[] = {
+        {Methods::AvailableCameras, &CameraAuroraPlugin::Dispatch<Args::None, &CameraAuroraPlugin::onAvailableCameras>},
+        {Methods::CreateCamera, &CameraAuroraPlugin::Dispatch<Args::CreateCamera, &CameraAuroraPlugin::onCreateCamera>},
+        {Methods::ResizeFrame, &CameraAuroraPlugin::Dispatch<Args::Frame, &CameraAuroraPlugin::onResizeFrame>},
+        {Methods::Dispose, &CameraAuroraPlugin::Dispatch<Args::Camera, &CameraAuroraPlugin::onDispose>},
+        {Methods::StartCapture, &CameraAuroraPlugin::Dispatch<Args::Frame, &CameraAuroraPlugin::onStartCapture>},
+        {Methods::StopCapture, &CameraAuroraPlugin::Dispatch<Args::Camera, &CameraAuroraPlugin::onStopCapture>},
+        {Methods::TakePicture, &CameraAuroraPlugin::Dispatch<Args::TakePicture, &CameraAuroraPlugin::onTakePicture>},
+        {Methods::PreCapture, &CameraAuroraPlugin::Dispatch<Args::PreCapture, &CameraAuroraPlugin::onPreCapture>},
+        {Methods::TakeBurst, &CameraAuroraPlugin::Dispatch<Args::TakeBurst, &CameraAuroraPlugin::onTakeBurst>},
+        {Methods::SetOutput, &CameraAuroraPlugin::Dispatch<Args::SetOutput, &CameraAuroraPlugin::onSetOutput>},
+        {Methods::SetStateWindow, &CameraAuroraPlugin::Dispatch<Args::StateWindow, &CameraAuroraPlugin::onSetStateWindow>},
+        {Methods::StartImageStream, &CameraAuroraPlugin::Dispatch<Args::ImageStream, &CameraAuroraPlugin::onStartImageStream>},
+        {Methods::StopImageStream, &CameraAuroraPlugin::Dispatch<Args::Camera, &CameraAuroraPlugin::onStopImageStream>},
+        {Methods::ReleaseFrame, &CameraAuroraPlugin::Dispatch<Args::ReleaseFrame, &CameraAuroraPlugin::onReleaseFrame>},
+        {Methods::SetStatsInterval, &CameraAuroraPlugin::Dispatch<Args::StatsInterval, &CameraAuroraPlugin::onSetStatsInterval>},
+        {Methods::StartTrace, &CameraAuroraPlugin::Dispatch<Args::StartTrace, &CameraAuroraPlugin::onStartTrace>},
+        {Methods::StopTrace, &CameraAuroraPlugin::Dispatch<Args::None, &CameraAuroraPlugin::onStopTrace>},
+        {Methods::DumpTrace, &CameraAuroraPlugin::Dispatch<Args::DumpTrace, &CameraAuroraPlugin::onDumpTrace>},
+        {Methods::GradeSheet, &CameraAuroraPlugin::Dispatch<Args::GradeSheet, &CameraAuroraPlugin::onGradeSheet>},
+        {Methods::RegisterSheetLayout, &CameraAuroraPlugin::Dispatch<Args::SheetLayout, &CameraAuroraPlugin::onRegisterSheetLayout>},
+        {Methods::SetAutoCapture, &CameraAuroraPlugin::Dispatch<Args::AutoCapture, &CameraAuroraPlugin::onSetAutoCapture>},
+    };
+
+    // Hashed once, a call costs one lookup
+    for (const auto &method : methods) {
+        m_methods.emplace(method.first, method.second);
+    }
+
     m_methodChannel->SetMethodCallHandler(
         [this](const MethodCall& call, std::unique_ptr<MethodResult> result) {
-            if (call.method_name().compare(Methods::ResizeFrame) == 0) {
-                result->Success(onResizeFrame(call));
-            }
-            else if (call.method_name().compare(Methods::AvailableCameras) == 0) {
-                result->Success(onAvailableCameras(call));
-            }
-            else if (call.method_name().compare(Methods::CreateCamera) == 0) {
-                result->Success(onCreateCamera(call));
-            }
-            else if (call.method_name().compare(Methods::StartCapture) == 0) {
-                result->Success(onStartCapture(call));
-            }
-            else if (call.method_name().compare(Methods::StopCapture) == 0) {
-                result->Success(onStopCapture(call));
-            }
-            else if (call.method_name().compare(Methods::Dispose) == 0) {
-                result->Success(onDispose(call));
-            }
-            else if (call.method_name().compare(Methods::TakePicture) == 0) {
-                m_textureCamera->GetImageBase64([result = std::shared_ptr<MethodResult>(std::move(result))](std::string base64) {
-                    result->Success(base64);
-                });
-            }
-            else {
+            auto method = m_methods.find(call.method_name());
+            if (method == m_methods.end()) {
                 result->Success();
+                return;
             }
+            // The key lives as long as the plugin, the span may keep it
+            trace::Scope span(method->first.c_str());
+            (this->*method->second)(call, std::move(result));
         });
 }
 
@@ -134,7 +360,15 @@ void CameraAuroraPlugin::RegisterStreamHandler()
         ) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
             m_sinkChange = std::move(events);
             m_stateEventChannelChange = true;
-            m_sinkChange->Success(m_textureCamera->GetState());
+            // A new listener starts from the full state
+            m_stateTimer.stop();
+            for (auto &item : m_states) {
+                item.second.Reset();
+            }
+            for (const auto &item : m_cameras) {
+                m_states[item.first].Merge(item.second.camera->GetState());
+            }
+            FlushState();
             return nullptr;
         },
         [&](const EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
@@ -152,79 +386,634 @@ void CameraAuroraPlugin::RegisterStreamHandler()
         ) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
             m_sinkQr = std::move(events);
             m_stateEventChannelQr = true;
-            m_textureCamera->EnableSearchQr(true);
+            for (const auto &item : m_cameras) {
+                item.second.camera->EnableSearchQr(true);
+            }
             return nullptr;
         },
         [&](const EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
             m_stateEventChannelQr = false;
-            m_textureCamera->EnableSearchQr(false);
+            for (const auto &item : m_cameras) {
+                item.second.camera->EnableSearchQr(false);
+            }
             return nullptr;
         }
     );
 
     m_eventChannelQr->SetStreamHandler(std::move(handlerQr));
+
+    // Set stream handler capture results
+    auto handlerCapture = std::make_unique<flutter::StreamHandlerFunctions<EncodableValue>>(
+        [&](const EncodableValue*,
+            std::unique_ptr<flutter::EventSink<EncodableValue>>&& events
+        ) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_sinkCapture = std::move(events);
+            m_stateEventChannelCapture = true;
+            return nullptr;
+        },
+        [&](const EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_stateEventChannelCapture = false;
+            return nullptr;
+        }
+    );
+
+    m_eventChannelCapture->SetStreamHandler(std::move(handlerCapture));
+
+    // Set stream handler image stream
+    auto handlerImage = std::make_unique<flutter::StreamHandlerFunctions<EncodableValue>>(
+        [&](const EncodableValue*,
+            std::unique_ptr<flutter::EventSink<EncodableValue>>&& events
+        ) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_sinkImage = std::move(events);
+            m_stateEventChannelImage = true;
+            return nullptr;
+        },
+        [&](const EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_stateEventChannelImage = false;
+            return nullptr;
+        }
+    );
+
+    m_eventChannelImage->SetStreamHandler(std::move(handlerImage));
+
+    // Set stream handler statistics
+    auto handlerStats = std::make_unique<flutter::StreamHandlerFunctions<EncodableValue>>(
+        [&](const EncodableValue*,
+            std::unique_ptr<flutter::EventSink<EncodableValue>>&& events
+        ) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_sinkStats = std::move(events);
+            m_stateEventChannelStats = true;
+            for (const auto &item : m_cameras) {
+                item.second.camera->Stats()->SetEnabled(true);
+            }
+            m_statsTimer.start();
+            return nullptr;
+        },
+        [&](const EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_stateEventChannelStats = false;
+            m_statsTimer.stop();
+            for (const auto &item : m_cameras) {
+                item.second.camera->Stats()->SetEnabled(false);
+            }
+            return nullptr;
+        }
+    );
+
+    m_eventChannelStats->SetStreamHandler(std::move(handlerStats));
+
+    // Set stream handler sheet detection, searched while listened to or auto capturing
+    auto handlerSheet = std::make_unique<flutter::StreamHandlerFunctions<EncodableValue>>(
+        [&](const EncodableValue*,
+            std::unique_ptr<flutter::EventSink<EncodableValue>>&& events
+        ) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_sinkSheet = std::move(events);
+            m_stateEventChannelSheet = true;
+            for (const auto &item : m_cameras) {
+                item.second.camera->SetSheetHandler(MakeSheetHandler());
+            }
+            return nullptr;
+        },
+        [&](const EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<EncodableValue>> {
+            m_stateEventChannelSheet = false;
+            for (const auto &item : m_cameras) {
+                item.second.camera->SetSheetHandler(nullptr);
+            }
+            return nullptr;
+        }
+    );
+
+    m_eventChannelSheet->SetStreamHandler(std::move(handlerSheet));
+}
+
+bool CameraAuroraPlugin::event(QEvent *event)
+{
+    if (event->type() == TaskEvent::EventType) {
+        trace::NameThread("platform");
+        trace::Scope span("platform.task");
+        static_cast<TaskEvent *>(event)->task();
+        return true;
+    }
+    return QObject::event(event);
+}
+
+void CameraAuroraPlugin::PostToPlatform(const std::function<void()> &task)
+{
+    // Thread-safe, the event is delivered by the loop of the platform thread
+    QCoreApplication::postEvent(this, new TaskEvent(task));
+}
+
+void CameraAuroraPlugin::RunOnCamera(SerialQueue queue,
+                                     std::unique_ptr<MethodResult> result,
+                                     const std::function<EncodableValue()> &task)
+{
+    queue.Post([this, task, result = std::shared_ptr<MethodResult>(std::move(result))] {
+        trace::NameThread("camera.worker");
+        auto value = [&task] {
+            trace::Scope span("camera.call");
+            return task();
+        }();
+        PostToPlatform([result, value] {
+            result->Success(value);
+        });
+    });
+}
+
+void CameraAuroraPlugin::SendState(int64_t cameraId, const EncodableMap &state)
+{
+    PostToPlatform([this, cameraId, state] {
+        // A disposed camera sent its last state already
+        if (!Find(cameraId)) {
+            return;
+        }
+        m_states[cameraId].Merge(state);
+        if (m_stateTimer.interval() == 0) {
+            FlushState();
+        } else if (!m_stateTimer.isActive()) {
+            m_stateTimer.start();
+        }
+    });
 }
 
-EncodableValue CameraAuroraPlugin::onResizeFrame(const MethodCall& method_call)
+void CameraAuroraPlugin::FlushState()
 {
-    if (Helper::TypeIs<EncodableMap>(*method_call.arguments())) {
-        const EncodableMap params = Helper::GetValue<EncodableMap>(*method_call.arguments());
-        auto width = Helper::GetInt(params, "width");
-        auto height = Helper::GetInt(params, "height");
-        auto state = m_textureCamera->ResizeFrame(width, height);
-        if (m_stateEventChannelChange) {
-            m_sinkChange->Success(state);
+    trace::Scope span("state.flush");
+
+    for (auto &item : m_states) {
+        FlushState(item.first, item.second);
+    }
+}
+
+void CameraAuroraPlugin::FlushState(int64_t cameraId, StateCoalescer &state)
+{
+    auto delta = state.TakeDelta();
+    if (!delta.empty() && m_stateEventChannelChange) {
+        delta[EncodableValue("cameraId")] = EncodableValue(cameraId);
+        m_sinkChange->Success(delta);
+    }
+}
+
+void CameraAuroraPlugin::SendStats()
+{
+    if (!m_stateEventChannelStats) {
+        return;
+    }
+
+    for (const auto &item : m_cameras) {
+        auto snapshot = item.second.camera->Stats()->Take();
+        auto seconds = snapshot.seconds > 0 ? snapshot.seconds : 1.0;
+
+        EncodableMap drops;
+        for (size_t i = 0; i < FrameStats::Drops; i++) {
+            auto name = FrameStats::DropName(static_cast<FrameStats::Drop>(i));
+            drops.emplace(name, static_cast<int64_t>(snapshot.drops[i]));
+        }
+
+        // Durations in microseconds
+        EncodableMap stages;
+        for (size_t i = 0; i < FrameStats::Stages; i++) {
+            const auto &stage = snapshot.stages[i];
+            stages.emplace(FrameStats::StageName(static_cast<FrameStats::Stage>(i)), EncodableMap{
+                {"count", static_cast<int64_t>(stage.count)},
+                {"p50", static_cast<int64_t>(stage.p50)},
+                {"p95", static_cast<int64_t>(stage.p95)},
+                {"p99", static_cast<int64_t>(stage.p99)},
+                {"max", static_cast<int64_t>(stage.max)},
+            });
         }
+
+        m_sinkStats->Success(EncodableMap{
+            {"cameraId", item.first},
+            {"seconds", snapshot.seconds},
+            {"fpsIn", snapshot.framesIn / seconds},
+            {"fpsOut", snapshot.framesOut / seconds},
+            {"allocated", static_cast<int64_t>(snapshot.allocated)},
+            {"drops", drops},
+            {"stages", stages},
+        });
+    }
+}
+
+void CameraAuroraPlugin::onResizeFrame(const Args::Frame& args,
+                                       std::unique_ptr<MethodResult> result)
+{
+    // Called on every layout pass, mostly with the size it already has
+    auto camera = Route(args.cameraId);
+    if (!camera || (args.width == camera->width && args.height == camera->height)) {
+        result->Success();
+        return;
     }
-    return EncodableValue();
+    camera->width = args.width;
+    camera->height = args.height;
+    RunOnCamera(camera->queue, std::move(result), [this, camera = camera->camera, args] {
+        SendState(camera->CameraId(), camera->ResizeFrame(args.width, args.height));
+        return EncodableValue();
+    });
 }
 
-EncodableValue CameraAuroraPlugin::onAvailableCameras(const MethodCall&)
+void CameraAuroraPlugin::onAvailableCameras(const Args::None&,
+                                            std::unique_ptr<MethodResult> result)
 {
-    return m_textureCamera->GetAvailableCameras();
+    result->Success(TextureCamera::GetAvailableCameras());
 }
 
-EncodableValue CameraAuroraPlugin::onCreateCamera(const MethodCall& method_call)
+void CameraAuroraPlugin::onCreateCamera(const Args::CreateCamera& args,
+                                        std::unique_ptr<MethodResult> result)
 {
-    if (Helper::TypeIs<EncodableMap>(*method_call.arguments())) {
-        const EncodableMap params = Helper::GetValue<EncodableMap>(*method_call.arguments());
-        auto cameraName = Helper::GetString(params, "cameraName");
-        auto state = m_textureCamera->Register(cameraName);
-        if (m_stateEventChannelChange) {
-            m_sinkChange->Success(state);
+    // One instance per device
+    for (const auto &item : m_cameras) {
+        if (item.second.camera->CameraName() == args.cameraName) {
+            result->Success(item.second.camera->GetState());
+            return;
         }
-        return state;
     }
-    return EncodableValue();
+
+    // A device being opened: the caller gets the same answer as the first
+    auto creating = m_creating.find(args.cameraName);
+    if (creating != m_creating.end()) {
+        creating->second.push_back(std::move(result));
+        return;
+    }
+    m_creating[args.cameraName].push_back(std::move(result));
+
+    // Create and dispose of the same device are serialised by its queue
+    auto queue = m_queues.emplace(args.cameraName, SerialQueue(m_worker.get())).first->second;
+    auto camera = MakeCamera();
+
+    queue.Post([this, queue, camera, cameraName = args.cameraName] {
+        auto state = camera->Register(cameraName);
+        auto opened = state.find(EncodableValue("textureId")) != state.end();
+        if (!opened) {
+            // The texture is registered before the device is opened
+            camera->Unregister();
+        }
+        PostToPlatform([this, queue, camera, cameraName, state, opened] {
+            auto results = std::move(m_creating[cameraName]);
+            m_creating.erase(cameraName);
+
+            if (opened) {
+                auto cameraId = camera->CameraId();
+                m_cameras.erase(cameraId);
+                m_cameras.emplace(cameraId, Camera{camera, queue});
+                m_states[cameraId].Reset();
+                UpdateBudget();
+                SendState(cameraId, state);
+            }
+            for (const auto &result : results) {
+                result->Success(state);
+            }
+        });
+    });
+}
+
+void CameraAuroraPlugin::onStartCapture(const Args::Frame& args,
+                                        std::unique_ptr<MethodResult> result)
+{
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+    camera->width = args.width;
+    camera->height = args.height;
+    RunOnCamera(camera->queue, std::move(result), [this, camera = camera->camera, args] {
+        SendState(camera->CameraId(), camera->StartCapture(args.width, args.height));
+        return EncodableValue();
+    });
+}
+
+void CameraAuroraPlugin::onStopCapture(const Args::Camera& args,
+                                       std::unique_ptr<MethodResult> result)
+{
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+    RunOnCamera(camera->queue, std::move(result), [camera = camera->camera] {
+        camera->StopCapture();
+        return EncodableValue();
+    });
+}
+
+void CameraAuroraPlugin::onPreCapture(const Args::PreCapture& args,
+                                      std::unique_ptr<MethodResult> result)
+{
+    if (auto camera = Route(args.cameraId)) {
+        camera->camera->SetPreCapture(args.frames);
+    }
+    result->Success();
+}
+
+void CameraAuroraPlugin::onSetOutput(const Args::SetOutput& args,
+                                     std::unique_ptr<MethodResult> result)
+{
+    yuv::OutputOptions options;
+    options.longEdge = std::max(0, args.longEdge);
+    options.dpi = std::max(0, args.dpi);
+
+    if (args.format == "gray") {
+        options.format = yuv::OutputFormat::Gray;
+    } else if (args.format == "binary") {
+        options.format = yuv::OutputFormat::Binary;
+    }
+
+    if (auto camera = Route(args.cameraId)) {
+        camera->camera->SetOutput(options);
+    }
+    result->Success();
 }
 
-EncodableValue CameraAuroraPlugin::onStartCapture(const MethodCall& method_call)
+void CameraAuroraPlugin::onTakePicture(const Args::TakePicture& args,
+                                       std::unique_ptr<MethodResult> result)
 {
-    if (Helper::TypeIs<EncodableMap>(*method_call.arguments())) {
-        const EncodableMap params = Helper::GetValue<EncodableMap>(*method_call.arguments());
-        auto width = Helper::GetInt(params, "width");
-        auto height = Helper::GetInt(params, "height");
-        auto state = m_textureCamera->StartCapture(width, height);
-        if (m_stateEventChannelChange) {
-            m_sinkChange->Success(state);
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+
+    // Progressive: a thumbnail now, the full image on the capture results channel
+    if (args.thumbnail > 0) {
+        camera->camera->GetProgressiveImageBase64(args.thumbnail,
+            [this, result = std::shared_ptr<MethodResult>(std::move(result))](const CaptureTimeline &timeline,
+                                                                               std::string base64) {
+                PostToPlatform([result, timeline = timeline, base64]() mutable {
+                    timeline.Mark("delivered");
+                    result->Success(EncodableMap{
+                        {"captureId", timeline.CaptureId()},
+                        {"thumbnail", base64},
+                        {"timings", timeline.Stages()},
+                    });
+                });
+            });
+        return;
+    }
+
+    // The stage times go with the image, to be matched with the upload
+    camera->camera->GetImageBase64([this, result = std::shared_ptr<MethodResult>(std::move(result))](const CaptureTimeline &timeline,
+                                                                                                      std::string base64) {
+        PostToPlatform([result, timeline = timeline, base64]() mutable {
+            timeline.Mark("delivered");
+            result->Success(EncodableMap{
+                {"captureId", timeline.CaptureId()},
+                {"image", base64},
+                {"timings", timeline.Stages()},
+            });
+        });
+    });
+}
+
+void CameraAuroraPlugin::onGradeSheet(const Args::GradeSheet& args,
+                                      std::unique_ptr<MethodResult> result)
+{
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+
+    // The /upload reply of the server, built on the worker that graded
+    GradeHandler onGrade =
+        [this, result = std::shared_ptr<MethodResult>(std::move(result))](const omr::Result &graded) {
+            EncodableList answers;
+            for (const auto &answer : graded.answers) {
+                answers.push_back(EncodableMap{
+                    {"question", answer.question},
+                    {"answer", answer.answer},
+                    {"correct-answer", answer.correctAnswer},
+                    {"confidence", static_cast<double>(answer.confidence)},
+                });
+            }
+
+            EncodableMap timings;
+            for (size_t stage = 0; stage < omr::Result::Stages; stage++) {
+                timings.emplace(omr::Result::StageName(static_cast<omr::Result::Stage>(stage)),
+                                graded.micros[stage]);
+            }
+
+            EncodableMap reply{
+                {"answers", answers},
+                {"total-correct-answers", graded.correct},
+                {"total-incorrect-answers", graded.incorrect},
+                {"timings", timings},
+                {"error", graded.error},
+            };
+
+            PostToPlatform([result, reply] {
+                result->Success(reply);
+            });
+        };
+
+    std::shared_ptr<const omr::CompiledLayout> layout;
+    if (!args.layout.empty()) {
+        layout = m_layouts.Find(args.layout);
+        if (!layout) {
+            omr::Result unknown;
+            unknown.error = "Unknown sheet layout";
+            onGrade(unknown);
+            return;
         }
     }
-    return EncodableValue();
+
+    camera->camera->GradeSheet(args.key, layout, onGrade);
+}
+
+void CameraAuroraPlugin::onRegisterSheetLayout(const Args::SheetLayout& args,
+                                               std::unique_ptr<MethodResult> result)
+{
+    omr::Layout layout;
+    layout.id = args.id;
+    layout.questions = args.questions;
+    layout.options = args.options;
+    layout.width = args.width;
+    layout.height = args.height;
+    layout.header = static_cast<float>(args.header);
+    layout.labels = static_cast<float>(args.labels);
+    layout.inset = static_cast<float>(args.inset);
+    layout.fiducialSize = static_cast<float>(args.fiducialSize);
+
+    for (size_t index = 0; index + 1 < args.fiducials.size(); index += 2) {
+        layout.fiducials.push_back(omr::Point{static_cast<float>(args.fiducials[index]),
+                                              static_cast<float>(args.fiducials[index + 1])});
+    }
+
+    // Compiled here once, the gradings share it
+    result->Success(EncodableValue(m_layouts.Add(layout)));
+}
+
+void CameraAuroraPlugin::onSetAutoCapture(const Args::AutoCapture& args,
+                                          std::unique_ptr<MethodResult> result)
+{
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+
+    // Captures arrive on the capture results channel, "detected" first
+    AutoCapture::Options options;
+    options.enabled = args.enabled;
+    options.stableFrames = args.stableFrames;
+    options.maxTilt = static_cast<float>(args.maxTilt);
+    options.maxJitter = static_cast<float>(args.maxJitter);
+    options.minSharpness = args.minSharpness;
+    options.margin = static_cast<float>(args.margin);
+
+    camera->camera->SetAutoCapture(options);
+    result->Success();
+}
+
+void CameraAuroraPlugin::onTakeBurst(const Args::TakeBurst& args,
+                                     std::unique_ptr<MethodResult> result)
+{
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+
+    camera->camera->GetBurstImageBase64(args.count, args.interval,
+        [this, result = std::shared_ptr<MethodResult>(std::move(result))](std::string base64) {
+            PostToPlatform([result, base64] {
+                result->Success(base64);
+            });
+        });
 }
 
-EncodableValue CameraAuroraPlugin::onStopCapture(const MethodCall&)
+void CameraAuroraPlugin::onStartImageStream(const Args::ImageStream& args,
+                                            std::unique_ptr<MethodResult> result)
 {
-    m_textureCamera->StopCapture();
-    return EncodableValue();
+    FrameStream::Options options;
+    options.format = args.format == "i420" ? FrameStream::Format::I420 : FrameStream::Format::Y;
+    options.longEdge = args.longEdge;
+    options.fps = args.fps;
+    options.buffers = args.buffers;
+
+    if (auto camera = Route(args.cameraId)) {
+        camera->camera->StartImageStream(options);
+    }
+    result->Success();
 }
 
-EncodableValue CameraAuroraPlugin::onDispose(const MethodCall&)
+void CameraAuroraPlugin::onStopImageStream(const Args::Camera& args,
+                                           std::unique_ptr<MethodResult> result)
 {
-    auto state = m_textureCamera->Unregister();
-    if (m_stateEventChannelChange) {
-        m_sinkChange->Success(state);
+    if (auto camera = Route(args.cameraId)) {
+        camera->camera->StopImageStream();
     }
-    return EncodableValue();
+    result->Success();
+}
+
+void CameraAuroraPlugin::onReleaseFrame(const Args::ReleaseFrame& args,
+                                        std::unique_ptr<MethodResult> result)
+{
+    if (auto camera = Route(args.cameraId)) {
+        camera->camera->ReleaseFrame(args.slot, args.sequence);
+    } else {
+        ReleaseFrame(args.cameraId, args.slot, args.sequence);
+    }
+    result->Success();
+}
+
+void CameraAuroraPlugin::ReleaseFrame(int64_t cameraId, int slot, int64_t sequence)
+{
+    if (auto camera = Find(cameraId)) {
+        camera->camera->ReleaseFrame(slot, sequence);
+        return;
+    }
+
+    // A disposed camera, its stream goes with its last frame
+    auto stream = m_streams.find(cameraId);
+    if (stream != m_streams.end()) {
+        stream->second->Release(slot, sequence);
+        if (!stream->second->IsHeld()) {
+            m_streams.erase(stream);
+        }
+    }
+}
+
+void CameraAuroraPlugin::onSetStateWindow(const Args::StateWindow& args,
+                                          std::unique_ptr<MethodResult> result)
+{
+    if (args.window >= 0) {
+        m_stateTimer.setInterval(args.window);
+    }
+    result->Success();
+}
+
+void CameraAuroraPlugin::onSetStatsInterval(const Args::StatsInterval& args,
+                                            std::unique_ptr<MethodResult> result)
+{
+    if (args.interval > 0) {
+        m_statsTimer.setInterval(args.interval);
+    }
+    result->Success();
+}
+
+void CameraAuroraPlugin::onStartTrace(const Args::StartTrace& args,
+                                      std::unique_ptr<MethodResult> result)
+{
+    trace::Start(args.capacity > 0 ? static_cast<size_t>(args.capacity) : trace::DefaultCapacity);
+    result->Success();
+}
+
+void CameraAuroraPlugin::onStopTrace(const Args::None&, std::unique_ptr<MethodResult> result)
+{
+    trace::Stop();
+    result->Success();
+}
+
+void CameraAuroraPlugin::onDumpTrace(const Args::DumpTrace& args,
+                                     std::unique_ptr<MethodResult> result)
+{
+    if (args.path.empty()) {
+        result->Success(EncodableValue(""));
+        return;
+    }
+
+    // Written on the workers, the recording goes on meanwhile
+    m_pool->Post([this, path = args.path, result = std::shared_ptr<MethodResult>(std::move(result))] {
+        auto value = trace::Dump(path) ? path : "";
+        PostToPlatform([result, value] {
+            result->Success(EncodableValue(value));
+        });
+    });
+}
+
+void CameraAuroraPlugin::onDispose(const Args::Camera& args, std::unique_ptr<MethodResult> result)
+{
+    auto camera = Route(args.cameraId);
+    if (!camera) {
+        result->Success();
+        return;
+    }
+
+    // Out of the registry now, the queue keeps the instance until it stops
+    auto cameraId = camera->camera->CameraId();
+    auto queue = camera->queue;
+    auto instance = camera->camera;
+
+    m_cameras.erase(cameraId);
+    UpdateBudget();
+
+    // Dart may still read frames of the camera in place
+    auto stream = instance->ImageStream();
+    stream->Stop();
+    if (stream->IsHeld()) {
+        m_streams[cameraId] = stream;
+    }
+
+    // The last state goes out right away, the entry goes with it
+    queue.Post([this, instance, cameraId, result = std::shared_ptr<MethodResult>(std::move(result))] {
+        auto state = instance->Unregister();
+        PostToPlatform([this, cameraId, state, result] {
+            auto &coalescer = m_states[cameraId];
+            coalescer.Merge(state);
+            FlushState(cameraId, coalescer);
+            m_states.erase(cameraId);
+            result->Success();
+        });
+    });
 }
 
 #include "moc_camera_aurora_plugin.cpp"
@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/frame_analyzer.h>
+#include <camera_aurora/trace.h>
+
+#include <algorithm>
+
+FrameAnalyzers::FrameAnalyzers(ThreadPool *pool, const std::shared_ptr<FrameStats> &stats)
+    : m_pool(pool)
+    , m_stats(stats)
+{}
+
+void FrameAnalyzers::Add(const std::shared_ptr<FrameAnalyzer> &analyzer,
+                         std::chrono::milliseconds interval)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->analyzer = analyzer;
+    entry->interval = std::max(interval, std::chrono::milliseconds(0));
+    entry->next = FrameView::Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto name = analyzer->Name();
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&name](const auto &item) {
+        return item->analyzer->Name() == name;
+    });
+
+    if (it != m_entries.end()) {
+        *it = entry;
+    } else {
+        m_entries.push_back(entry);
+    }
+}
+
+void FrameAnalyzers::Remove(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A running task keeps its entry, the analyzer ends with it
+    m_entries.erase(std::remove_if(m_entries.begin(),
+                                   m_entries.end(),
+                                   [&name](const auto &item) {
+                                       return item->analyzer->Name() == name;
+                                   }),
+                    m_entries.end());
+}
+
+bool FrameAnalyzers::IsEmpty() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.empty();
+}
+
+void FrameAnalyzers::Dispatch(const FrameView &frame, const std::shared_ptr<const void> &owner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const auto &entry : m_entries) {
+        if (frame.timestamp < entry->next || entry->busy.exchange(true)) {
+            continue;
+        }
+
+        entry->next = frame.timestamp + entry->interval;
+
+        m_pool->Post([entry, frame, owner, stats = m_stats] {
+            trace::NameThread("worker");
+            trace::Scope span("analyze");
+            auto start = stats->Now();
+            entry->analyzer->Analyze(frame);
+            stats->Record(FrameStats::Stage::Analyze, start);
+            entry->busy = false;
+        });
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/frame_ring.h>
+#include <camera_aurora/yuv_metrics.h>
+
+#include <libyuv/libyuv.h>
+
+FrameRing::FrameRing(size_t memoryCap)
+    : m_memoryCap(memoryCap)
+{}
+
+void FrameRing::Configure(int frames)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requested = frames < 0 ? 0 : frames;
+
+    // Push is not called on a disabled ring, nothing else would free it
+    if (m_requested == 0 && m_allocated != 0) {
+        Allocate(0, 0, 0);
+    }
+}
+
+bool FrameRing::IsEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_requested > 0;
+}
+
+void FrameRing::Allocate(int frames, int width, int height)
+{
+    m_storage = nullptr;
+    m_slots.clear();
+    m_allocated = frames;
+    m_width = width;
+    m_height = height;
+    m_next = 0;
+
+    auto sizeY = static_cast<size_t>(width) * height;
+    auto sizeUV = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    auto frameSize = sizeY + sizeUV * 2;
+
+    // Strict memory cap: drop slots that do not fit
+    auto count = static_cast<size_t>(frames);
+    if (count * frameSize > m_memoryCap) {
+        count = m_memoryCap / frameSize;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    m_storage = std::shared_ptr<uint8_t>((uint8_t *) malloc(count * frameSize), free);
+
+    if (!m_storage) {
+        return;
+    }
+
+    m_slots.reserve(count);
+
+    for (size_t index = 0; index < count; index++) {
+        auto y = m_storage.get() + index * frameSize;
+        m_slots.push_back(Slot{y, y + sizeY, y + sizeY + sizeUV, width, height, 0, {}, false});
+    }
+}
+
+void FrameRing::Push(const uint8_t *srcY,
+                     int strideY,
+                     const uint8_t *srcU,
+                     int strideU,
+                     const uint8_t *srcV,
+                     int strideV,
+                     int width,
+                     int height,
+                     bool measure)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_requested == 0) {
+        return;
+    }
+
+    if (m_allocated != m_requested || m_width != width || m_height != height) {
+        Allocate(m_requested, width, height);
+    }
+
+    if (m_slots.empty()) {
+        return;
+    }
+
+    auto &slot = m_slots[m_next];
+    auto strideUV = (width + 1) / 2;
+
+    if (srcV) {
+        libyuv::I420Copy(srcY, strideY, srcU, strideU, srcV, strideV,
+                         slot.y, width, slot.u, strideUV, slot.v, strideUV,
+                         width, height);
+    } else {
+        libyuv::NV12ToI420(srcY, strideY, srcU, strideU,
+                           slot.y, width, slot.u, strideUV, slot.v, strideUV,
+                           width, height);
+    }
+
+    slot.sharpness = measure ? yuv::Sharpness(slot.y, width, width, height) : 0;
+    slot.time = Clock::now();
+    slot.filled = true;
+
+    m_next = (m_next + 1) % m_slots.size();
+}
+
+std::shared_ptr<const FrameRing::Slot> FrameRing::Sharpest(Clock::time_point time) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Slot *result = nullptr;
+
+    for (const auto &slot : m_slots) {
+        if (slot.filled && slot.time <= time
+            && (!result || slot.sharpness > result->sharpness)) {
+            result = &slot;
+        }
+    }
+
+    if (!result) {
+        return nullptr;
+    }
+
+    // A copy of the slot sharing the ownership of the storage
+    struct Pinned
+    {
+        Slot slot;
+        std::shared_ptr<uint8_t> storage;
+    };
+
+    auto pinned = std::make_shared<Pinned>(Pinned{*result, m_storage});
+    return std::shared_ptr<const Slot>(pinned, &pinned->slot);
+}
+
+void FrameRing::Release()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requested = 0;
+    Allocate(0, 0, 0);
+}
+
+size_t FrameRing::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slots.size();
+}
+
+size_t FrameRing::Filled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t count = 0;
+
+    for (const auto &slot : m_slots) {
+        count += slot.filled ? 1 : 0;
+    }
+
+    return count;
+}
+
+FrameRing::Slot *FrameRing::At(size_t index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return index < m_slots.size() ? &m_slots[index] : nullptr;
+}
+
+void FrameRing::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto &slot : m_slots) {
+        slot.filled = false;
+    }
+
+    m_next = 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/frame_stats.h>
+
+#include <algorithm>
+
+int LatencyHistogram::Index(uint64_t micros)
+{
+    if (micros < SubBuckets) {
+        return static_cast<int>(micros);
+    }
+
+    auto bit = 63 - __builtin_clzll(micros);
+    if (bit > MaxBit) {
+        return Buckets - 1;
+    }
+
+    return (bit - 2) * SubBuckets + static_cast<int>((micros >> (bit - 3)) & (SubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::Value(int index)
+{
+    if (index < SubBuckets) {
+        return index;
+    }
+
+    // Middle of the bucket
+    auto shift = index / SubBuckets - 1;
+    auto lower = static_cast<uint64_t>(SubBuckets + index % SubBuckets) << shift;
+    return lower + (static_cast<uint64_t>(1) << shift) / 2;
+}
+
+void LatencyHistogram::Record(uint64_t micros)
+{
+    m_buckets[Index(micros)].fetch_add(1, std::memory_order_relaxed);
+
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (micros > max && !m_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::Take()
+{
+    std::array<uint32_t, Buckets> counts;
+    Summary summary;
+
+    for (int i = 0; i < Buckets; i++) {
+        counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+        summary.count += counts[i];
+    }
+
+    summary.max = m_max.exchange(0, std::memory_order_relaxed);
+
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    // Nearest-rank quantiles
+    auto rank50 = (summary.count * 50 + 99) / 100;
+    auto rank95 = (summary.count * 95 + 99) / 100;
+    auto rank99 = (summary.count * 99 + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < Buckets; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        auto before = seen;
+        seen += counts[i];
+        auto value = std::min(Value(i), summary.max);
+        if (before < rank50 && rank50 <= seen) {
+            summary.p50 = value;
+        }
+        if (before < rank95 && rank95 <= seen) {
+            summary.p95 = value;
+        }
+        if (before < rank99 && rank99 <= seen) {
+            summary.p99 = value;
+        }
+    }
+
+    return summary;
+}
+
+const char *FrameStats::StageName(Stage stage)
+{
+    switch (stage) {
+    case Stage::Map:
+        return "map";
+    case Stage::Scale:
+        return "scale";
+    case Stage::Convert:
+        return "convert";
+    case Stage::Analyze:
+        return "analyze";
+    case Stage::Available:
+        return "available";
+    case Stage::Pull:
+        return "pull";
+    }
+    return "";
+}
+
+const char *FrameStats::DropName(Drop drop)
+{
+    switch (drop) {
+    case Drop::Decimate:
+        return "decimate";
+    case Drop::Budget:
+        return "budget";
+    case Drop::Capture:
+        return "capture";
+    case Drop::Stream:
+        return "stream";
+    }
+    return "";
+}
+
+void FrameStats::SetEnabled(bool enabled)
+{
+    if (enabled && !m_enabled) {
+        Take();
+    }
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool FrameStats::IsEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+FrameStats::Clock::time_point FrameStats::Now() const
+{
+    return IsEnabled() ? Clock::now() : Clock::time_point();
+}
+
+FrameStats::Clock::time_point FrameStats::Record(Stage stage, Clock::time_point start)
+{
+    if (start == Clock::time_point()) {
+        return start;
+    }
+
+    auto now = Clock::now();
+    Record(stage, now - start);
+    return now;
+}
+
+void FrameStats::Record(Stage stage, Clock::duration duration)
+{
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    m_stages[static_cast<size_t>(stage)].Record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+}
+
+void FrameStats::CountIn()
+{
+    if (IsEnabled()) {
+        m_framesIn.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameStats::CountOut()
+{
+    if (IsEnabled()) {
+        m_framesOut.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameStats::CountDrop(Drop drop)
+{
+    if (IsEnabled()) {
+        m_drops[static_cast<size_t>(drop)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameStats::CountAllocated(size_t bytes)
+{
+    if (IsEnabled()) {
+        m_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+FrameStats::Snapshot FrameStats::Take()
+{
+    Snapshot snapshot;
+
+    auto now = Clock::now().time_since_epoch().count();
+    auto since = m_since.exchange(now, std::memory_order_relaxed);
+    snapshot.seconds = since == 0 ? 0 : std::chrono::duration<double>(Clock::duration(now - since)).count();
+
+    snapshot.framesIn = m_framesIn.exchange(0, std::memory_order_relaxed);
+    snapshot.framesOut = m_framesOut.exchange(0, std::memory_order_relaxed);
+    snapshot.allocated = m_allocated.exchange(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < Drops; i++) {
+        snapshot.drops[i] = m_drops[i].exchange(0, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < Stages; i++) {
+        snapshot.stages[i] = m_stages[i].Take();
+    }
+
+    return snapshot;
+}
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/frame_stream.h>
+
+#include <libyuv/libyuv.h>
+
+#include <algorithm>
+
+namespace {
+
+bool AnyHeld(const std::vector<int64_t> &held)
+{
+    return std::find_if(held.begin(), held.end(), [](int64_t sequence) { return sequence != 0; })
+        != held.end();
+}
+
+} // namespace
+
+void FrameStream::Start(const Options &options)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_options = options;
+    m_options.buffers = std::min(std::max(options.buffers, 1), 8);
+    m_options.longEdge = std::max(options.longEdge, 16);
+    m_options.fps = std::max(options.fps, 0);
+    m_enabled = true;
+    Retire();
+    m_next = Clock::now();
+}
+
+void FrameStream::Stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_enabled = false;
+    Retire();
+}
+
+bool FrameStream::IsEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_enabled;
+}
+
+void FrameStream::Retire()
+{
+    // Held slots stay readable, the next frame gets a new block
+    if (!AnyHeld(m_held)) {
+        return;
+    }
+
+    m_retired.push_back(Block{std::move(m_storage), std::move(m_held)});
+    m_storage = nullptr;
+    m_held.clear();
+    m_scratch = nullptr;
+}
+
+bool FrameStream::Allocate(int width, int height)
+{
+    if (AnyHeld(m_held)) {
+        return false;
+    }
+
+    auto longEdge = std::max(width, height);
+    auto outWidth = width;
+    auto outHeight = height;
+
+    // Even sizes keep the chroma planes aligned
+    if (m_options.longEdge < longEdge) {
+        outWidth = std::max(2, (width * m_options.longEdge / longEdge) & ~1);
+        outHeight = std::max(2, (height * m_options.longEdge / longEdge) & ~1);
+    }
+
+    auto sizeY = static_cast<size_t>(outWidth) * outHeight;
+    auto sizeUV = static_cast<size_t>((outWidth + 1) / 2) * ((outHeight + 1) / 2);
+    auto isI420 = m_options.format == Format::I420;
+
+    m_slotSize = isI420 ? sizeY + sizeUV * 2 : sizeY;
+
+    // NV12 chroma is scaled interleaved and split into the slot
+    auto scratch = isI420 ? sizeUV * 2 : 0;
+    auto total = m_slotSize * m_options.buffers + scratch;
+
+    m_storage = std::shared_ptr<uint8_t>((uint8_t *) malloc(total), free);
+    m_held.assign(m_storage ? m_options.buffers : 0, 0);
+    m_scratch = isI420 && m_storage ? m_storage.get() + m_slotSize * m_options.buffers : nullptr;
+    m_allocated = m_options;
+    m_srcWidth = width;
+    m_srcHeight = height;
+    m_width = outWidth;
+    m_height = outHeight;
+
+    return m_storage != nullptr;
+}
+
+bool FrameStream::Push(const uint8_t *srcY,
+                       int strideY,
+                       const uint8_t *srcU,
+                       int strideU,
+                       const uint8_t *srcV,
+                       int strideV,
+                       int width,
+                       int height,
+                       Frame &frame)
+{
+    int slot = -1;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_enabled) {
+            return false;
+        }
+
+        auto now = Clock::now();
+
+        if (m_options.fps > 0) {
+            if (now < m_next) {
+                return false;
+            }
+            m_next += std::chrono::microseconds(1000000 / m_options.fps);
+            if (m_next < now) {
+                m_next = now;
+            }
+        }
+
+        auto changed = m_allocated.buffers != m_options.buffers
+                       || m_allocated.longEdge != m_options.longEdge
+                       || m_allocated.format != m_options.format || m_srcWidth != width
+                       || m_srcHeight != height;
+
+        // Waits for Dart to release the old buffers before reallocating
+        if ((changed || !m_storage) && !Allocate(width, height)) {
+            m_dropped++;
+            return false;
+        }
+
+        for (size_t index = 0; index < m_held.size(); index++) {
+            if (m_held[index] == 0) {
+                slot = static_cast<int>(index);
+                break;
+            }
+        }
+
+        if (slot < 0) {
+            m_dropped++;
+            return false;
+        }
+
+        m_held[slot] = ++m_sequence;
+
+        auto data = m_storage.get() + m_slotSize * slot;
+        auto sizeY = static_cast<size_t>(m_width) * m_height;
+        auto strideUV = (m_width + 1) / 2;
+        auto isI420 = m_options.format == Format::I420;
+
+        frame = Frame{slot,
+                      m_sequence,
+                      data,
+                      m_slotSize,
+                      data,
+                      isI420 ? data + sizeY : nullptr,
+                      isI420 ? data + sizeY + strideUV * ((m_height + 1) / 2) : nullptr,
+                      m_width,
+                      isI420 ? strideUV : 0,
+                      m_width,
+                      m_height,
+                      m_options.format,
+                      m_dropped};
+    }
+
+    // The slot is ours and the storage cannot change while it is busy,
+    // only the camera thread pushes so the scratch is ours too
+    if (!frame.u) {
+        libyuv::ScalePlane(srcY, strideY, width, height,
+                           frame.y, frame.strideY, frame.width, frame.height,
+                           libyuv::kFilterBox);
+    } else if (srcV) {
+        libyuv::I420Scale(srcY, strideY, srcU, strideU, srcV, strideV, width, height,
+                          frame.y, frame.strideY, frame.u, frame.strideUV, frame.v, frame.strideUV,
+                          frame.width, frame.height, libyuv::kFilterBox);
+    } else {
+        auto srcWidthUV = (width + 1) / 2;
+        auto srcHeightUV = (height + 1) / 2;
+        auto heightUV = (frame.height + 1) / 2;
+
+        libyuv::ScalePlane(srcY, strideY, width, height,
+                           frame.y, frame.strideY, frame.width, frame.height,
+                           libyuv::kFilterBox);
+        libyuv::UVScale(srcU, strideU, srcWidthUV, srcHeightUV,
+                        m_scratch, frame.strideUV * 2, frame.strideUV, heightUV,
+                        libyuv::kFilterBox);
+        libyuv::SplitUVPlane(m_scratch, frame.strideUV * 2,
+                             frame.u, frame.strideUV, frame.v, frame.strideUV,
+                             frame.strideUV, heightUV);
+    }
+
+    return true;
+}
+
+void FrameStream::Release(int slot, int64_t sequence)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (slot < 0 || sequence <= 0) {
+        return;
+    }
+
+    // A late release must not free the slot's next frame
+    if (static_cast<size_t>(slot) < m_held.size() && m_held[slot] == sequence) {
+        m_held[slot] = 0;
+        return;
+    }
+
+    // Sequences are unique, the frame is in one retired block at most
+    for (auto block = m_retired.begin(); block != m_retired.end(); block++) {
+        if (static_cast<size_t>(slot) < block->held.size() && block->held[slot] == sequence) {
+            block->held[slot] = 0;
+            if (!AnyHeld(block->held)) {
+                m_retired.erase(block);
+            }
+            return;
+        }
+    }
+}
+
+uint64_t FrameStream::Dropped() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+bool FrameStream::IsHeld() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_retired.empty() || AnyHeld(m_held);
+}
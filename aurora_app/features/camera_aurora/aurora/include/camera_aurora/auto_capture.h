@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_AUTO_CAPTURE_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_AUTO_CAPTURE_H
+
+#include <camera_aurora/sheet_analyzer.h>
+
+// Decides from the sheet reports when the full image is worth taking:
+// the table is inside the frame, seen nearly straight on, still for a
+// number of frames in a row and in focus. After a capture the table
+// must be lost before the next one, a sheet is captured once.
+class AutoCapture
+{
+public:
+    struct Options
+    {
+        bool enabled = false;
+        int stableFrames = 8;       // in a row, at SheetAnalyzer::Interval
+        float maxTilt = 0.15f;      // omr::Tilt
+        float maxJitter = 0.005f;   // share of the frame
+        double minSharpness = 30;   // yuv::Sharpness of the preview
+        float margin = 0.02f;       // corners this far from the frame edges
+    };
+
+    // Starts over, the current table may be captured
+    void Configure(const Options &options);
+    bool IsEnabled() const;
+
+    // True for the one report the capture should follow
+    bool Check(const SheetAnalyzer::Sheet &sheet);
+
+private:
+    bool IsInside(const omr::Quad &corners) const;
+
+private:
+    Options m_options;
+    int m_stable = 0;
+    bool m_armed = true;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_AUTO_CAPTURE_H */
@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_BINARIZE_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_BINARIZE_H
+
+#include <array>
+#include <cstdint>
+
+namespace binarize {
+
+typedef std::array<uint32_t, 256> Histogram;
+
+// Counts of every value of an 8-bit plane
+Histogram MakeHistogram(const uint8_t *src, int stride, int width, int height);
+
+// Otsu's threshold: the value splitting the histogram into two classes
+// of the largest between-class variance, values above it are the
+// brighter class
+int Otsu(const Histogram &histogram);
+
+// Adaptive mean threshold over a `window` x `window` neighbourhood:
+// a pixel darker than the local mean minus `c` is ink. Ink is written
+// as 0 and paper as 255, or the other way round with `invert`.
+void AdaptiveThreshold(const uint8_t *src,
+                       int srcStride,
+                       uint8_t *dst,
+                       int dstStride,
+                       int width,
+                       int height,
+                       int window,
+                       int c,
+                       bool invert = false);
+
+// Plain loops producing the same output, the baseline of the benchmark.
+// The functions above use SSE2 or NEON where the compiler targets them.
+namespace scalar {
+
+Histogram MakeHistogram(const uint8_t *src, int stride, int width, int height);
+
+void AdaptiveThreshold(const uint8_t *src,
+                       int srcStride,
+                       uint8_t *dst,
+                       int dstStride,
+                       int width,
+                       int height,
+                       int window,
+                       int c,
+                       bool invert = false);
+
+} // namespace scalar
+
+} // namespace binarize
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_BINARIZE_H */
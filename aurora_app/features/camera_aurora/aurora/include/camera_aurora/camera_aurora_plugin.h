@@ -7,7 +7,14 @@
 
 #include <camera_aurora/globals.h>
 #include <camera_aurora/texture_camera.h>
+#include <camera_aurora/thread_pool.h>
 #include <camera_aurora/encodable_helper.h>
+#include <camera_aurora/frame_budget.h>
+#include <camera_aurora/method_args.h>
+#include <camera_aurora/omr/layout.h>
+#include <camera_aurora/serial_queue.h>
+#include <camera_aurora/state_coalescer.h>
+#include <camera_aurora/trace.h>
 
 #include <flutter/flutter_aurora.h>
 #include <flutter/plugin_registrar.h>
@@ -18,7 +25,12 @@
 #include <flutter/standard_method_codec.h>
 #include <flutter/event_stream_handler_functions.h>
 
+#include <unordered_map>
+#include <vector>
+
+#include <QEvent>
 #include <QImage>
+#include <QTimer>
 #include <QtCore>
 
 typedef flutter::Plugin Plugin;
@@ -38,38 +50,121 @@ class PLUGIN_EXPORT CameraAuroraPlugin final
 public:
     static void RegisterWithRegistrar(PluginRegistrar* registrar);
 
+protected:
+    bool event(QEvent *event) override;
+
 private:
     // Creates a plugin that communicates on the given channel.
     CameraAuroraPlugin(
         PluginRegistrar* registrar,
         std::unique_ptr<MethodChannel> methodChannel,
         std::unique_ptr<EventChannel> eventChannelChange,
-        std::unique_ptr<EventChannel> eventChannelQr
+        std::unique_ptr<EventChannel> eventChannelQr,
+        std::unique_ptr<EventChannel> eventChannelCapture,
+        std::unique_ptr<EventChannel> eventChannelImage,
+        std::unique_ptr<EventChannel> eventChannelStats,
+        std::unique_ptr<EventChannel> eventChannelSheet
     );
 
+    typedef void (CameraAuroraPlugin::*MethodHandler)(const MethodCall &call,
+                                                      std::unique_ptr<MethodResult> result);
+
+    // Decodes the arguments of a call into T and passes them to Handler
+    template<typename T,
+             void (CameraAuroraPlugin::*Handler)(const T &, std::unique_ptr<MethodResult>)>
+    void Dispatch(const MethodCall &call, std::unique_ptr<MethodResult> result);
+
     // Methods register handlers channels
     void RegisterMethodHandler();
     void RegisterStreamHandler();
 
+    // Open cameras by texture ID, each with the queue of its device
+    struct Camera
+    {
+        std::shared_ptr<TextureCamera> camera;
+        SerialQueue queue;
+        int width = 0; // of the last start or resize, repeats are dropped
+        int height = 0;
+    };
+
+    std::shared_ptr<TextureCamera> MakeCamera();
+    Camera *Find(int64_t cameraId);
+    Camera *Route(int64_t cameraId);
+    void UpdateBudget();
+    SheetHandler MakeSheetHandler();
+
+    // Threads: calls to a camera run one by one on the shared workers,
+    // results and events are sent from the platform thread
+    void RunOnCamera(SerialQueue queue,
+                     std::unique_ptr<MethodResult> result,
+                     const std::function<EncodableValue()> &task);
+    void PostToPlatform(const std::function<void()> &task);
+    void SendState(int64_t cameraId, const EncodableMap &state);
+    void FlushState();
+    void FlushState(int64_t cameraId, StateCoalescer &state);
+    void SendStats();
+    void ReleaseFrame(int64_t cameraId, int slot, int64_t sequence);
+
     // Methods MethodCall
-    EncodableValue onResizeFrame(const MethodCall &call);
-    EncodableValue onAvailableCameras(const MethodCall &call);
-    EncodableValue onCreateCamera(const MethodCall &call);
-    EncodableValue onStartCapture(const MethodCall &call);
-    EncodableValue onStopCapture(const MethodCall &call);
-    EncodableValue onDispose(const MethodCall &call);
-
-    std::unique_ptr<TextureCamera> m_textureCamera;
+    void onResizeFrame(const Args::Frame &args, std::unique_ptr<MethodResult> result);
+    void onAvailableCameras(const Args::None &args, std::unique_ptr<MethodResult> result);
+    void onCreateCamera(const Args::CreateCamera &args, std::unique_ptr<MethodResult> result);
+    void onStartCapture(const Args::Frame &args, std::unique_ptr<MethodResult> result);
+    void onStopCapture(const Args::Camera &args, std::unique_ptr<MethodResult> result);
+    void onDispose(const Args::Camera &args, std::unique_ptr<MethodResult> result);
+    void onPreCapture(const Args::PreCapture &args, std::unique_ptr<MethodResult> result);
+    void onSetOutput(const Args::SetOutput &args, std::unique_ptr<MethodResult> result);
+    void onTakePicture(const Args::TakePicture &args, std::unique_ptr<MethodResult> result);
+    void onGradeSheet(const Args::GradeSheet &args, std::unique_ptr<MethodResult> result);
+    void onRegisterSheetLayout(const Args::SheetLayout &args, std::unique_ptr<MethodResult> result);
+    void onSetAutoCapture(const Args::AutoCapture &args, std::unique_ptr<MethodResult> result);
+    void onTakeBurst(const Args::TakeBurst &args, std::unique_ptr<MethodResult> result);
+    void onStartImageStream(const Args::ImageStream &args, std::unique_ptr<MethodResult> result);
+    void onStopImageStream(const Args::Camera &args, std::unique_ptr<MethodResult> result);
+    void onReleaseFrame(const Args::ReleaseFrame &args, std::unique_ptr<MethodResult> result);
+    void onSetStateWindow(const Args::StateWindow &args, std::unique_ptr<MethodResult> result);
+    void onSetStatsInterval(const Args::StatsInterval &args, std::unique_ptr<MethodResult> result);
+    void onStartTrace(const Args::StartTrace &args, std::unique_ptr<MethodResult> result);
+    void onStopTrace(const Args::None &args, std::unique_ptr<MethodResult> result);
+    void onDumpTrace(const Args::DumpTrace &args, std::unique_ptr<MethodResult> result);
+
+    TextureRegistrar* m_textures;
+    std::unordered_map<int64_t, Camera> m_cameras;
+    std::unordered_map<std::string, SerialQueue> m_queues;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<MethodResult>>> m_creating;
+    std::unordered_map<int64_t, std::shared_ptr<FrameStream>> m_streams; // of disposed cameras
+    FrameBudget m_budget;
+    omr::LayoutRegistry m_layouts;
+
+    std::unique_ptr<ThreadPool> m_pool;
+    std::unique_ptr<ThreadPool> m_worker;
     
     std::unique_ptr<MethodChannel> m_methodChannel;
+    std::unordered_map<std::string, MethodHandler> m_methods;
     std::unique_ptr<EventChannel> m_eventChannelChange;
     std::unique_ptr<EventChannel> m_eventChannelQr;
+    std::unique_ptr<EventChannel> m_eventChannelCapture;
+    std::unique_ptr<EventChannel> m_eventChannelImage;
+    std::unique_ptr<EventChannel> m_eventChannelStats;
+    std::unique_ptr<EventChannel> m_eventChannelSheet;
+
+    std::unordered_map<int64_t, StateCoalescer> m_states;
+    QTimer m_stateTimer;
+    QTimer m_statsTimer;
 
     std::unique_ptr<EventSink> m_sinkChange;
     std::unique_ptr<EventSink> m_sinkQr;
+    std::unique_ptr<EventSink> m_sinkCapture;
+    std::unique_ptr<EventSink> m_sinkImage;
+    std::unique_ptr<EventSink> m_sinkStats;
+    std::unique_ptr<EventSink> m_sinkSheet;
 
     bool m_stateEventChannelChange = false;
     bool m_stateEventChannelQr = false;
+    bool m_stateEventChannelCapture = false;
+    bool m_stateEventChannelImage = false;
+    bool m_stateEventChannelStats = false;
+    bool m_stateEventChannelSheet = false;
 };
 
 #endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_H */
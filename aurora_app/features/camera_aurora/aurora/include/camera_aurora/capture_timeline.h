@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_CAPTURE_TIMELINE_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_CAPTURE_TIMELINE_H
+
+#include <camera_aurora/encodable_helper.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+// Stage times of one capture in microseconds since the epoch. They are
+// lined up with the stages of the app and the backend, hence the wall
+// clock rather than the monotonic one.
+class CaptureTimeline
+{
+public:
+    explicit CaptureTimeline(int64_t captureId = 0)
+        : m_captureId(captureId)
+    {}
+
+    static int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // A new capture ID, positive. IDs are distinct within the process and
+    // random across launches and devices: the backend logs them together.
+    static int64_t NextId()
+    {
+        static const uint64_t nonce = [] {
+            std::random_device random;
+            return (static_cast<uint64_t>(random()) << 32 | random()) ^ static_cast<uint64_t>(Now());
+        }();
+        static std::atomic<uint64_t> counter{0};
+
+        // splitmix64 of the counter: a bijection, the counters do not collide
+        auto z = nonce + ++counter * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+
+        // Positive: the top bit goes, a pair of IDs may meet with odds of 2^-63
+        auto id = static_cast<int64_t>(z & 0x7FFFFFFFFFFFFFFFull);
+        return id != 0 ? id : 1;
+    }
+
+    int64_t CaptureId() const
+    {
+        return m_captureId;
+    }
+
+    void Mark(const std::string &stage)
+    {
+        m_stages[EncodableValue(stage)] = EncodableValue(Now());
+    }
+
+    const EncodableMap &Stages() const
+    {
+        return m_stages;
+    }
+
+private:
+    int64_t m_captureId;
+    EncodableMap m_stages;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_CAPTURE_TIMELINE_H */
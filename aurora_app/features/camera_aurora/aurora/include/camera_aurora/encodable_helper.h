@@ -17,27 +17,29 @@ namespace Helper {
 // ========== encodable_value ==========
 
 template <typename T>
-inline bool TypeIs(const EncodableValue val) {
+inline bool TypeIs(const EncodableValue& val) {
   return std::holds_alternative<T>(val);
 }
 
 template <typename T>
-inline const T GetValue(EncodableValue val) {
+inline const T& GetValue(const EncodableValue& val) {
   return std::get<T>(val);
 }
 
-inline EncodableMap GetMap(const EncodableMap& map, const std::string& key) {
+inline const EncodableMap& GetMap(const EncodableMap& map, const std::string& key) {
+  static const EncodableMap empty;
   auto it = map.find(EncodableValue(key));
   if (it != map.end() && TypeIs<EncodableMap>(it->second))
     return GetValue<EncodableMap>(it->second);
-  return EncodableMap();
+  return empty;
 }
 
-inline EncodableList GetList(const EncodableMap& map, const std::string& key) {
+inline const EncodableList& GetList(const EncodableMap& map, const std::string& key) {
+  static const EncodableList empty;
   auto it = map.find(EncodableValue(key));
   if (it != map.end() && TypeIs<EncodableList>(it->second))
     return GetValue<EncodableList>(it->second);
-  return EncodableList();
+  return empty;
 }
 
 inline int GetInt(const EncodableMap& map, const std::string& key) {
@@ -65,7 +67,7 @@ inline std::vector<int> GetVectorInt(const EncodableMap& map, const std::string&
   auto it = map.find(EncodableValue(key));
   std::vector<int> result {};
   if (it != map.end() && TypeIs<std::vector<EncodableValue>>(it->second))
-    for(auto item : GetValue<std::vector<EncodableValue>>(it->second))
+    for(const auto& item : GetValue<std::vector<EncodableValue>>(it->second))
     {
       result.push_back(GetValue<int>(item));
     }
@@ -76,7 +78,7 @@ inline std::vector<double> GetVectorDouble(const EncodableMap& map, const std::s
   auto it = map.find(EncodableValue(key));
   std::vector<double> result {};
   if (it != map.end() && TypeIs<std::vector<EncodableValue>>(it->second))
-    for(auto item : GetValue<std::vector<EncodableValue>>(it->second))
+    for(const auto& item : GetValue<std::vector<EncodableValue>>(it->second))
     {
       result.push_back(GetValue<double>(item));
     }
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_ANALYZER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_ANALYZER_H
+
+#include <camera_aurora/frame_stats.h>
+#include <camera_aurora/thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Read-only view of a camera frame, the planes keep the camera strides.
+// For NV12 `u` is the interleaved plane and `v` is nullptr.
+struct FrameView
+{
+    typedef std::chrono::steady_clock Clock;
+
+    enum class Layout
+    {
+        I420,
+        NV12,
+    };
+
+    const uint8_t *y;
+    const uint8_t *u;
+    const uint8_t *v;
+    int strideY;
+    int strideUV;
+    int width;
+    int height;
+    Layout layout;
+    int64_t sequence;
+    Clock::time_point timestamp;
+};
+
+// Work done on preview frames: QR search, sheet detection, sharpness...
+// Analyze runs on the shared workers, never twice at the same time for
+// one analyzer, and must not keep the view after it returns.
+class FrameAnalyzer
+{
+public:
+    virtual ~FrameAnalyzer() = default;
+
+    virtual std::string Name() const = 0;
+    virtual void Analyze(const FrameView &frame) = 0;
+};
+
+// Analyzers of one camera. Dispatch hands the frame to every analyzer
+// that is idle and due, the frame is kept alive by `owner` until the
+// last of them is done. Busy or early analyzers skip the frame.
+class FrameAnalyzers
+{
+public:
+    // Run times are recorded in `stats` as FrameStats::Stage::Analyze
+    FrameAnalyzers(ThreadPool *pool, const std::shared_ptr<FrameStats> &stats);
+
+    // Replaces an analyzer of the same name; `interval` is the minimum
+    // time between two frames, 0 - every frame the analyzer is idle for
+    void Add(const std::shared_ptr<FrameAnalyzer> &analyzer,
+             std::chrono::milliseconds interval);
+    void Remove(const std::string &name);
+    bool IsEmpty() const;
+
+    void Dispatch(const FrameView &frame, const std::shared_ptr<const void> &owner);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<FrameAnalyzer> analyzer;
+        std::chrono::milliseconds interval;
+        FrameView::Clock::time_point next;
+        std::atomic<bool> busy{false};
+    };
+
+    ThreadPool *m_pool;
+    std::shared_ptr<FrameStats> m_stats;
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<Entry>> m_entries;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_ANALYZER_H */
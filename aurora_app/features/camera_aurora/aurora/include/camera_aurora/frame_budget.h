@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_BUDGET_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_BUDGET_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+// CPU time per second the cameras may spend on preview conversion,
+// split evenly between the open cameras. Each camera keeps its own
+// account and skips preview frames once its share is spent.
+class FrameBudget
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    class Account
+    {
+    public:
+        // True if the next frame fits in the share of the current second
+        bool Allow(const FrameBudget &budget)
+        {
+            auto now = Clock::now();
+            if (now - m_start >= std::chrono::seconds(1)) {
+                m_start = now;
+                m_spent = Clock::duration::zero();
+            }
+            return m_spent < budget.Share();
+        }
+
+        void Spend(Clock::duration time)
+        {
+            m_spent += time;
+        }
+
+    private:
+        Clock::time_point m_start;
+        Clock::duration m_spent = Clock::duration::zero();
+    };
+
+    explicit FrameBudget(std::chrono::milliseconds perSecond)
+        : m_perSecond(perSecond)
+    {}
+
+    void SetCameras(int cameras)
+    {
+        m_cameras = std::max(1, cameras);
+    }
+
+    Clock::duration Share() const
+    {
+        return m_perSecond / m_cameras.load();
+    }
+
+private:
+    Clock::duration m_perSecond;
+    std::atomic<int> m_cameras{1};
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_BUDGET_H */
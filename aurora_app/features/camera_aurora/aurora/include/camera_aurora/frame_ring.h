@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_RING_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_RING_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Ring of the last N camera frames stored as compact I420 copies.
+// The storage is one block allocated when the ring is configured or the
+// frame size changes, never per frame.
+class FrameRing
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot
+    {
+        uint8_t *y;
+        uint8_t *u;
+        uint8_t *v;
+        int width;
+        int height;
+        double sharpness;
+        Clock::time_point time;
+        bool filled;
+    };
+
+    explicit FrameRing(size_t memoryCap);
+
+    // Request a ring of `frames` slots, 0 disables the ring and frees memory
+    // at once. Thread-safe; the storage is (re)allocated lazily by the next
+    // Push.
+    void Configure(int frames);
+    bool IsEnabled() const;
+
+    // Copy a frame in the ring. For NV12 pass the interleaved plane as `srcU`
+    // and nullptr as `srcV`. With `measure` off the slot sharpness is left
+    // for the caller to fill.
+    void Push(const uint8_t *srcY,
+              int strideY,
+              const uint8_t *srcU,
+              int strideU,
+              const uint8_t *srcV,
+              int strideV,
+              int width,
+              int height,
+              bool measure = true);
+
+    // Free the storage now, the ring must not be in use by another thread
+    void Release();
+
+    // Number of slots allocated and filled
+    size_t Size() const;
+    size_t Filled() const;
+    Slot *At(size_t index);
+
+    // The sharpest frame received before `time`, or nullptr. The slot
+    // keeps its storage alive, the ring may be disabled meanwhile.
+    std::shared_ptr<const Slot> Sharpest(Clock::time_point time) const;
+
+    void Clear();
+
+private:
+    void Allocate(int frames, int width, int height);
+
+private:
+    size_t m_memoryCap;
+
+    mutable std::mutex m_mutex;
+    int m_requested = 0;
+
+    std::shared_ptr<uint8_t> m_storage;
+    std::vector<Slot> m_slots;
+    int m_allocated = 0;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_next = 0;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_RING_H */
@@ -0,0 +1,115 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_STATS_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free histogram of durations in microseconds. Buckets are linear
+// below 8 us, then 8 per power of two, so quantiles are within 12.5%.
+class LatencyHistogram
+{
+public:
+    struct Summary
+    {
+        uint64_t count = 0;
+        uint64_t p50 = 0;
+        uint64_t p95 = 0;
+        uint64_t p99 = 0;
+        uint64_t max = 0;
+    };
+
+    void Record(uint64_t micros);
+
+    // Summary of the values recorded since the last call
+    Summary Take();
+
+private:
+    static constexpr int SubBuckets = 8;
+    static constexpr int MaxBit = 31;
+    static constexpr int Buckets = (MaxBit - 1) * SubBuckets;
+
+    static int Index(uint64_t micros);
+    static uint64_t Value(int index);
+
+    std::array<std::atomic<uint32_t>, Buckets> m_buckets{};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// Rolling statistics of the frame pipeline of one camera. Nothing is
+// measured while disabled: Now() returns a zero time point and Record
+// ignores it, so the cost is a relaxed load per call.
+class FrameStats
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum class Stage
+    {
+        Map,       // buffer arrival to mapped planes
+        Scale,     // preview downscale
+        Convert,   // YUV to ARGB
+        Analyze,   // one analyzer run on the workers
+        Available, // buffer arrival to texture marked available
+        Pull,      // marked available to the engine pulling the pixels
+    };
+
+    enum class Drop
+    {
+        Decimate, // preview takes two frames of three
+        Budget,   // conversion budget spent
+        Capture,  // frame taken by a still capture
+        Stream,   // image stream buffers all held by Dart
+    };
+
+    static constexpr size_t Stages = 6;
+    static constexpr size_t Drops = 4;
+
+    struct Snapshot
+    {
+        double seconds = 0;
+        uint64_t framesIn = 0;
+        uint64_t framesOut = 0;
+        uint64_t allocated = 0;
+        std::array<uint64_t, Drops> drops{};
+        std::array<LatencyHistogram::Summary, Stages> stages{};
+    };
+
+    static const char *StageName(Stage stage);
+    static const char *DropName(Drop drop);
+
+    // Enabling starts a new window
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const;
+
+    Clock::time_point Now() const;
+
+    // Records the time since `start` unless it is zero, returns now
+    Clock::time_point Record(Stage stage, Clock::time_point start);
+    void Record(Stage stage, Clock::duration duration);
+
+    void CountIn();
+    void CountOut();
+    void CountDrop(Drop drop);
+    void CountAllocated(size_t bytes);
+
+    // Statistics since the last snapshot
+    Snapshot Take();
+
+private:
+    std::atomic<bool> m_enabled{false};
+    std::atomic<int64_t> m_since{0};
+    std::atomic<uint64_t> m_framesIn{0};
+    std::atomic<uint64_t> m_framesOut{0};
+    std::atomic<uint64_t> m_allocated{0};
+    std::array<std::atomic<uint64_t>, Drops> m_drops{};
+    std::array<LatencyHistogram, Stages> m_stages;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_STATS_H */
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_STREAM_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_STREAM_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Fixed ring of reusable buffers holding downscaled frames for Dart.
+// A filled slot belongs to Dart until it is released; when no slot is
+// free the frame is dropped. The storage is reallocated only when the
+// options or the frame size change and no slot is held by Dart. Dart
+// reads the slots in place, so a block with held slots is never freed
+// or refilled: Start and Stop retire it, and it is freed when its last
+// frame is released or the stream is destroyed.
+class FrameStream
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum class Format
+    {
+        Y,    // luma plane only
+        I420, // compact I420
+    };
+
+    struct Options
+    {
+        int buffers = 3;
+        int longEdge = 640;
+        int fps = 15;
+        Format format = Format::Y;
+    };
+
+    // A filled slot, u and v are nullptr for Format::Y. The sequence
+    // tells this use of the slot from earlier ones.
+    struct Frame
+    {
+        int slot;
+        int64_t sequence;
+        uint8_t *data;
+        size_t size;
+        uint8_t *y;
+        uint8_t *u;
+        uint8_t *v;
+        int strideY;
+        int strideUV;
+        int width;
+        int height;
+        Format format;
+        uint64_t dropped;
+    };
+
+    void Start(const Options &options);
+    void Stop();
+    bool IsEnabled() const;
+
+    // Scale a camera frame in a free slot. For NV12 pass the interleaved
+    // plane as `srcU` and nullptr as `srcV`. False if the frame is skipped
+    // by the rate cap or dropped for want of a free slot.
+    bool Push(const uint8_t *srcY,
+              int strideY,
+              const uint8_t *srcU,
+              int strideU,
+              const uint8_t *srcV,
+              int strideV,
+              int width,
+              int height,
+              Frame &frame);
+
+    // Dart is done with the slot, ignored unless it still holds the frame
+    // of `sequence`
+    void Release(int slot, int64_t sequence);
+
+    // Frames dropped because Dart held every slot
+    uint64_t Dropped() const;
+
+    // Dart holds a frame of this stream, of any block
+    bool IsHeld() const;
+
+private:
+    // Storage with the sequence of the frame in each slot, 0 if free
+    struct Block
+    {
+        std::shared_ptr<uint8_t> storage;
+        std::vector<int64_t> held;
+    };
+
+    bool Allocate(int width, int height);
+    void Retire();
+
+private:
+    mutable std::mutex m_mutex;
+    Options m_options;
+    bool m_enabled = false;
+
+    std::shared_ptr<uint8_t> m_storage;
+    std::vector<int64_t> m_held; // sequence of the frame in the slot, 0 if free
+    std::vector<Block> m_retired;
+    Options m_allocated;
+    int m_srcWidth = 0;
+    int m_srcHeight = 0;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_slotSize = 0;
+    uint8_t *m_scratch = nullptr;
+
+    Clock::time_point m_next;
+    int64_t m_sequence = 0;
+    uint64_t m_dropped = 0;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_FRAME_STREAM_H */
@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_JPEG_ENCODER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_JPEG_ENCODER_H
+
+#include <camera_aurora/thread_pool.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace jpeg {
+
+struct Planes
+{
+    const uint8_t *y;
+    int strideY;
+    const uint8_t *u; // Cb, nullptr - grayscale image
+    int strideU;
+    const uint8_t *v; // Cr
+    int strideV;
+    int width;
+    int height;
+};
+
+// Baseline JPEG encoder working straight on I420 planes (4:2:0 output) or
+// on a single Y plane. The image is split in horizontal strips of MCU rows;
+// with a pool the strips are encoded in parallel. Every MCU row ends with a
+// restart marker, so the strips are independent and their concatenation is
+// a valid stream. A non-zero `dpi` is written in the JFIF header.
+std::vector<uint8_t> Encode(const Planes &planes,
+                            int quality = 75,
+                            ThreadPool *pool = nullptr,
+                            int dpi = 0);
+
+} // namespace jpeg
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_JPEG_ENCODER_H */
@@ -0,0 +1,415 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_METHOD_ARGS_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_METHOD_ARGS_H
+
+#include <camera_aurora/encodable_helper.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Typed arguments of the method channel calls. A struct is filled in one
+// pass over the argument map, missing or mistyped keys keep the defaults.
+namespace Args {
+
+struct None
+{};
+
+struct CreateCamera
+{
+    std::string cameraName;
+};
+
+// Calls routed to one camera, the ID is its texture ID
+struct Camera
+{
+    int64_t cameraId = 0;
+};
+
+struct Frame : Camera
+{
+    int width = -1;
+    int height = -1;
+};
+
+struct PreCapture : Camera
+{
+    int frames = 0;
+};
+
+struct TakePicture : Camera
+{
+    int thumbnail = 0;
+};
+
+struct TakeBurst : Camera
+{
+    int count = 0;
+    int interval = 0;
+};
+
+struct SetOutput : Camera
+{
+    std::string format;
+    int longEdge = 0;
+    int dpi = 0;
+};
+
+struct ImageStream : Camera
+{
+    std::string format;
+    int longEdge = 640;
+    int fps = 15;
+    int buffers = 3;
+};
+
+struct ReleaseFrame : Camera
+{
+    int slot = -1;
+    int64_t sequence = 0;
+};
+
+struct GradeSheet : Camera
+{
+    std::map<std::string, std::string> key;
+    std::string layout; // ID of a registered layout, empty to search the grid
+};
+
+// omr::Layout, the fiducials as x, y pairs one after another
+struct SheetLayout
+{
+    std::string id;
+    int questions = 0;
+    int options = 0;
+    int width = 0;
+    int height = 0;
+    double header = 0;
+    double labels = 0;
+    double inset = 0.15;
+    std::vector<double> fiducials;
+    double fiducialSize = 0;
+};
+
+// Defaults of AutoCapture::Options, `enabled` off disables
+struct AutoCapture : Camera
+{
+    bool enabled = false;
+    int stableFrames = 8;
+    double maxTilt = 0.15;
+    double maxJitter = 0.005;
+    double minSharpness = 30;
+    double margin = 0.02;
+};
+
+struct StateWindow
+{
+    int window = -1;
+};
+
+struct StatsInterval
+{
+    int interval = -1;
+};
+
+struct StartTrace
+{
+    int capacity = 0;
+};
+
+struct DumpTrace
+{
+    std::string path;
+};
+
+inline void Read(const EncodableValue &value, int &field)
+{
+    if (auto number = std::get_if<int32_t>(&value)) {
+        field = *number;
+    } else if (auto number64 = std::get_if<int64_t>(&value)) {
+        field = static_cast<int>(*number64);
+    }
+}
+
+inline void Read(const EncodableValue &value, int64_t &field)
+{
+    if (auto number = std::get_if<int32_t>(&value)) {
+        field = *number;
+    } else if (auto number64 = std::get_if<int64_t>(&value)) {
+        field = *number64;
+    }
+}
+
+inline void Read(const EncodableValue &value, bool &field)
+{
+    if (auto flag = std::get_if<bool>(&value)) {
+        field = *flag;
+    }
+}
+
+inline void Read(const EncodableValue &value, double &field)
+{
+    if (auto number = std::get_if<double>(&value)) {
+        field = *number;
+    } else if (auto number32 = std::get_if<int32_t>(&value)) {
+        field = *number32;
+    } else if (auto number64 = std::get_if<int64_t>(&value)) {
+        field = static_cast<double>(*number64);
+    }
+}
+
+inline void Read(const EncodableValue &value, std::string &field)
+{
+    if (auto text = std::get_if<std::string>(&value)) {
+        field = *text;
+    }
+}
+
+inline void Read(const EncodableValue &value, std::vector<double> &field)
+{
+    auto list = std::get_if<EncodableList>(&value);
+    if (!list) {
+        return;
+    }
+
+    field.clear();
+    for (const auto &item : *list) {
+        double number = 0;
+        Read(item, number);
+        field.push_back(number);
+    }
+}
+
+// String to string map, numbers as keys are taken as their text
+inline void Read(const EncodableValue &value, std::map<std::string, std::string> &field)
+{
+    auto map = std::get_if<EncodableMap>(&value);
+    if (!map) {
+        return;
+    }
+
+    for (const auto &item : *map) {
+        std::string key;
+        if (auto number = std::get_if<int32_t>(&item.first)) {
+            key = std::to_string(*number);
+        } else if (auto number64 = std::get_if<int64_t>(&item.first)) {
+            key = std::to_string(*number64);
+        } else {
+            Read(item.first, key);
+        }
+
+        std::string text;
+        Read(item.second, text);
+
+        if (!key.empty()) {
+            field[key] = text;
+        }
+    }
+}
+
+inline void Field(CreateCamera &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraName") {
+        Read(value, args.cameraName);
+    }
+}
+
+inline void Field(Camera &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    }
+}
+
+inline void Field(Frame &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "width") {
+        Read(value, args.width);
+    } else if (key == "height") {
+        Read(value, args.height);
+    }
+}
+
+inline void Field(PreCapture &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "frames") {
+        Read(value, args.frames);
+    }
+}
+
+inline void Field(TakePicture &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "thumbnail") {
+        Read(value, args.thumbnail);
+    }
+}
+
+inline void Field(TakeBurst &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "count") {
+        Read(value, args.count);
+    } else if (key == "interval") {
+        Read(value, args.interval);
+    }
+}
+
+inline void Field(SetOutput &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "format") {
+        Read(value, args.format);
+    } else if (key == "longEdge") {
+        Read(value, args.longEdge);
+    } else if (key == "dpi") {
+        Read(value, args.dpi);
+    }
+}
+
+inline void Field(ImageStream &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "format") {
+        Read(value, args.format);
+    } else if (key == "longEdge") {
+        Read(value, args.longEdge);
+    } else if (key == "fps") {
+        Read(value, args.fps);
+    } else if (key == "buffers") {
+        Read(value, args.buffers);
+    }
+}
+
+inline void Field(ReleaseFrame &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "slot") {
+        Read(value, args.slot);
+    } else if (key == "sequence") {
+        Read(value, args.sequence);
+    }
+}
+
+inline void Field(GradeSheet &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "key") {
+        Read(value, args.key);
+    } else if (key == "layout") {
+        Read(value, args.layout);
+    }
+}
+
+inline void Field(SheetLayout &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "id") {
+        Read(value, args.id);
+    } else if (key == "questions") {
+        Read(value, args.questions);
+    } else if (key == "options") {
+        Read(value, args.options);
+    } else if (key == "width") {
+        Read(value, args.width);
+    } else if (key == "height") {
+        Read(value, args.height);
+    } else if (key == "header") {
+        Read(value, args.header);
+    } else if (key == "labels") {
+        Read(value, args.labels);
+    } else if (key == "inset") {
+        Read(value, args.inset);
+    } else if (key == "fiducials") {
+        Read(value, args.fiducials);
+    } else if (key == "fiducialSize") {
+        Read(value, args.fiducialSize);
+    }
+}
+
+inline void Field(AutoCapture &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "cameraId") {
+        Read(value, args.cameraId);
+    } else if (key == "enabled") {
+        Read(value, args.enabled);
+    } else if (key == "stableFrames") {
+        Read(value, args.stableFrames);
+    } else if (key == "maxTilt") {
+        Read(value, args.maxTilt);
+    } else if (key == "maxJitter") {
+        Read(value, args.maxJitter);
+    } else if (key == "minSharpness") {
+        Read(value, args.minSharpness);
+    } else if (key == "margin") {
+        Read(value, args.margin);
+    }
+}
+
+inline void Field(StateWindow &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "window") {
+        Read(value, args.window);
+    }
+}
+
+inline void Field(StatsInterval &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "interval") {
+        Read(value, args.interval);
+    }
+}
+
+inline void Field(StartTrace &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "capacity") {
+        Read(value, args.capacity);
+    }
+}
+
+inline void Field(DumpTrace &args, const std::string &key, const EncodableValue &value)
+{
+    if (key == "path") {
+        Read(value, args.path);
+    }
+}
+
+// False if the call arguments are not a map
+template <typename T>
+inline bool Decode(const EncodableValue *value, T &args)
+{
+    auto map = value ? std::get_if<EncodableMap>(value) : nullptr;
+
+    if (!map) {
+        return false;
+    }
+
+    for (const auto &item : *map) {
+        if (auto key = std::get_if<std::string>(&item.first)) {
+            Field(args, *key, item.second);
+        }
+    }
+
+    return true;
+}
+
+inline bool Decode(const EncodableValue *, None &)
+{
+    return true;
+}
+
+} // namespace Args
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_METHOD_ARGS_H */
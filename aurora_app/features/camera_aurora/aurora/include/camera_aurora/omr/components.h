@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_COMPONENTS_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_COMPONENTS_H
+
+#include <camera_aurora/omr/image.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace omr {
+
+// Connected components, one array per property: entry i of each array
+// belongs to component i. Filters over them are plain loops over a few
+// arrays rather than over whole structs.
+struct Components
+{
+    std::vector<int> left;
+    std::vector<int> top;
+    std::vector<int> width;
+    std::vector<int> height;
+    std::vector<int> area; // pixels
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+
+    size_t Size() const
+    {
+        return area.size();
+    }
+
+    Rect Box(size_t index) const
+    {
+        return Rect{left[index], top[index], width[index], height[index]};
+    }
+};
+
+// 8-connected components of the non-zero pixels, in the order of their
+// first pixel. One pass collects the runs of every row and joins them
+// with the overlapping runs of the row above through union-find. With
+// `labels` every pixel gets the index of its component plus one, 0 for
+// the background.
+Components FindComponents(const Image &binary, std::vector<int32_t> *labels = nullptr);
+
+// Indexes of the components whose mask entry is not 0, in order
+std::vector<int> Select(const std::vector<uint8_t> &mask);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_COMPONENTS_H */
@@ -0,0 +1,38 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_CORNERS_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_CORNERS_H
+
+#include <camera_aurora/omr/image.h>
+
+#include <cstdint>
+
+namespace omr {
+
+// Long edge the table is searched at, the corners are scaled back
+constexpr int CornerSearchSize = 1024;
+
+// Time of the search in microseconds: binarize downscales, blurs,
+// thresholds and closes the plane, detect labels the outlines and fits
+// the quad
+struct CornerTimes
+{
+    int64_t binarize = 0;
+    int64_t detect = 0;
+};
+
+// The answer table: the largest dark outline of the plane after blur,
+// inverted Otsu threshold and closing, as find_table_corners does. Its
+// corners are the outline's extreme points along both diagonals, taken
+// after undoing the outline's skew. False if nothing large enough is
+// found. Preview frames are searched smaller.
+bool FindCorners(const Plane &plane,
+                 Quad &corners,
+                 int searchSize = CornerSearchSize,
+                 CornerTimes *times = nullptr);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_CORNERS_H */
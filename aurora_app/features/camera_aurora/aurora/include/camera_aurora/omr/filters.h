@@ -0,0 +1,29 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_FILTERS_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_FILTERS_H
+
+#include <camera_aurora/omr/image.h>
+
+namespace omr {
+
+// 5x5 Gaussian with OpenCV's kernel for sigma 0, 1 4 6 4 1 each way;
+// the edge pixels are repeated
+Image GaussianBlur(const Plane &src);
+
+// Pixels above `threshold` become 255 and the others 0, the other way
+// round with `invert`
+Image Threshold(const Plane &src, int threshold, bool invert);
+
+// Threshold at Otsu's value of the plane
+Image ThresholdOtsu(const Plane &src, bool invert);
+
+// Closing of the 255 pixels with a `size` x `size` square: dilation,
+// then erosion. Pixels outside of the image are ignored.
+Image Close(const Image &src, int size);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_FILTERS_H */
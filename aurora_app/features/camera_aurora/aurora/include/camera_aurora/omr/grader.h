@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_GRADER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_GRADER_H
+
+#include <camera_aurora/omr/image.h>
+#include <camera_aurora/omr/layout.h>
+#include <camera_aurora/thread_pool.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace omr {
+
+// Correct answers by question number, "1" -> "A"
+typedef std::map<std::string, std::string> AnswerKey;
+
+struct Answer
+{
+    std::string question;
+    std::string answer;
+    std::string correctAnswer;
+    float confidence = 0; // of the mark, 0 when the cell is barely darker
+};
+
+// What /upload returns, with the time of every stage
+struct Result
+{
+    enum class Stage
+    {
+        Binarize, // of the table search
+        Corners,  // outlines labelled and the quad fit
+        Warp,
+        Grid,
+        Marks,
+        Compare,
+    };
+
+    static constexpr size_t Stages = 6;
+    static const char *StageName(Stage stage);
+
+    std::string error; // empty on success
+    std::vector<Answer> answers;
+    int correct = 0;
+    int incorrect = 0;
+    std::array<int64_t, Stages> micros{}; // duration of each stage
+};
+
+// The aurora_cv pipeline on the luma plane of a photo, upright: table
+// corners, perspective fix, grid, marked cells, comparison with the key.
+// With a pool the perspective fix is split over the workers.
+Result Grade(const Plane &plane, const AnswerKey &key, ThreadPool *pool = nullptr);
+
+// The same on a sheet of a known layout: the table is straightened to
+// the layout's size, the fiducials are checked and the layout's cells
+// are measured in place of the grid search
+Result Grade(const Plane &plane, const CompiledLayout &layout, const AnswerKey &key,
+             ThreadPool *pool = nullptr);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_GRADER_H */
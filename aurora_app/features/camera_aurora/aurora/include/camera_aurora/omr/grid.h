@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_GRID_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_GRID_H
+
+#include <camera_aurora/omr/image.h>
+
+#include <vector>
+
+namespace omr {
+
+// Cells of the straightened table, the light areas between its lines.
+// The header row holds the answer letters, the first column the
+// question numbers; the corner cell is in neither.
+struct Grid
+{
+    std::vector<Rect> columns;   // A, B, ... left to right
+    std::vector<Rect> questions; // 1, 2, ... top to bottom
+    std::vector<Rect> cells;     // the answer cells
+};
+
+// Otsu threshold and components of the light areas, sorted out by
+// where they start as scan_and_mark_cells does
+Grid FindGrid(const Image &table);
+
+// Ink in a cell after the contrast and sharpening of
+// detect_empty_contours. The cell is marked when it is darker than 240
+// on average. `confidence` grows from 0 at that mean to 1 at the median
+// mark of the sheet, or at the paper for blank cells: a faint mark or a
+// smudge next to clear marks is low.
+struct Fill
+{
+    Rect cell;
+    float ratio = 0; // 1 - mean / 255
+    float confidence = 0;
+    bool marked = false;
+};
+
+// A marked cell in a question row and a letter column
+struct Mark
+{
+    int question = 0;
+    int column = 0;
+    float confidence = 0;
+};
+
+// Fill of every cell: one pass builds a summed-area table of the
+// enhanced table, then each cell is four lookups
+std::vector<Fill> MeasureFill(const Image &table, const std::vector<Rect> &cells);
+
+// The marked ones of MeasureFill
+std::vector<Fill> FindMarked(const Image &table, const std::vector<Rect> &cells);
+
+// Marks whose cell center is in a question row and a letter column,
+// sorted by question and column, without repeats
+std::vector<Mark> MatchMarks(const Grid &grid, const std::vector<Fill> &marked);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_GRID_H */
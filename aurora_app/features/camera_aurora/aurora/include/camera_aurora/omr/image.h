@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_IMAGE_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_IMAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Answer sheet grading on the luma plane, the pipeline of the server's
+// aurora_cv without OpenCV. Nothing here depends on Qt or Flutter.
+namespace omr {
+
+// Read-only 8-bit plane, rows `stride` bytes apart
+struct Plane
+{
+    const uint8_t *data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+
+    const uint8_t *Row(int y) const
+    {
+        return data + static_cast<ptrdiff_t>(y) * stride;
+    }
+};
+
+// 8-bit image with packed rows
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;
+
+    Image() = default;
+
+    Image(int width, int height, uint8_t value = 0)
+        : width(width)
+        , height(height)
+        , data(static_cast<size_t>(width) * height, value)
+    {}
+
+    bool IsEmpty() const
+    {
+        return data.empty();
+    }
+
+    uint8_t *Row(int y)
+    {
+        return data.data() + static_cast<size_t>(y) * width;
+    }
+
+    const uint8_t *Row(int y) const
+    {
+        return data.data() + static_cast<size_t>(y) * width;
+    }
+
+    Plane View() const
+    {
+        return Plane{data.data(), width, height, width};
+    }
+};
+
+struct Point
+{
+    float x = 0;
+    float y = 0;
+};
+
+// Corners clockwise from the top left
+typedef std::array<Point, 4> Quad;
+
+struct Rect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    int Area() const
+    {
+        return width * height;
+    }
+};
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_IMAGE_H */
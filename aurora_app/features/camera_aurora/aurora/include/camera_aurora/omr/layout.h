@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_LAYOUT_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_LAYOUT_H
+
+#include <camera_aurora/omr/image.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace omr {
+
+// A printed answer table, in shares of the straightened table: the
+// header row of letters on top, the column of question numbers on the
+// left, and a grid of questions x options equal cells in the rest.
+// Fiducials are dark square markers printed inside the table outline.
+struct Layout
+{
+    std::string id;
+    int questions = 0;
+    int options = 0;
+    int width = 0;  // straightened table, pixels
+    int height = 0;
+    float header = 0; // height of the letter row
+    float labels = 0; // width of the question column
+    float inset = 0.15f; // share of a cell left out on every side: the lines
+    std::vector<Point> fiducials; // centers
+    float fiducialSize = 0; // side, share of the table width
+};
+
+// Empty if the layout can be compiled, what is wrong with it otherwise
+std::string Check(const Layout &layout);
+
+// A layout in pixels of its straightened size. Cell i is question
+// i / options, option i % options; nothing is searched for when
+// grading, the cells are where the layout puts them.
+class CompiledLayout
+{
+public:
+    explicit CompiledLayout(const Layout &layout);
+
+    const Layout &Source() const
+    {
+        return m_layout;
+    }
+
+    int Index(int question, int option) const
+    {
+        return question * m_layout.options + option;
+    }
+
+    const std::vector<Rect> &Cells() const
+    {
+        return m_cells;
+    }
+
+    const std::vector<Rect> &Fiducials() const
+    {
+        return m_fiducials;
+    }
+
+private:
+    Layout m_layout;
+    std::vector<Rect> m_cells;
+    std::vector<Rect> m_fiducials;
+};
+
+// Compiled layouts by ID, shared by the cameras. A layout is compiled
+// once when added, grading takes the compiled one.
+class LayoutRegistry
+{
+public:
+    // Empty on success, the Check error otherwise. A layout with the
+    // same ID is replaced, gradings holding the old one finish with it.
+    std::string Add(const Layout &layout);
+
+    // Null if there is no such layout
+    std::shared_ptr<const CompiledLayout> Find(const std::string &id) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::shared_ptr<const CompiledLayout>> m_layouts;
+};
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_LAYOUT_H */
@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_SKEW_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_SKEW_H
+
+#include <camera_aurora/omr/image.h>
+
+namespace omr {
+
+// Skews beyond this are not searched, degrees
+constexpr float MaxSkew = 30;
+
+// Angle of the ink lines of a binary image in radians, clockwise:
+// rotating the image back by it makes its lines horizontal and
+// vertical. The image is decimated 4x, a block with any non-zero pixel
+// is ink, and the angle is the one whose row and column projection
+// profiles are the peakiest, in 1 degree steps, then 0.1 degree.
+float EstimateSkew(const Image &binary);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_SKEW_H */
@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_TRACKER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_TRACKER_H
+
+#include <camera_aurora/omr/image.h>
+
+#include <cstddef>
+#include <deque>
+
+namespace omr {
+
+// Table corners of the last preview frames, as shares of the frame
+// width and height so that the scores do not depend on the frame size
+class QuadTracker
+{
+public:
+    static constexpr size_t DefaultFrames = 8;
+
+    // Corners moving this far, share of the frame, score no stability
+    static constexpr float JitterLimit = 0.02f;
+
+    explicit QuadTracker(size_t frames = DefaultFrames);
+
+    void Add(const Quad &corners);
+    void Reset(); // the table is lost
+
+    size_t Frames() const;
+    bool IsEmpty() const;
+
+    // RMS distance of the corners from their mean position
+    float Jitter() const;
+
+    // 1 - the table was still in all the frames, 0 - it moves or is lost
+    float Stability() const;
+
+private:
+    size_t m_frames;
+    std::deque<Quad> m_history;
+};
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_TRACKER_H */
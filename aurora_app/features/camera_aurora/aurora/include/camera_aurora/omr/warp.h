@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_WARP_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_WARP_H
+
+#include <camera_aurora/omr/image.h>
+#include <camera_aurora/thread_pool.h>
+
+namespace omr {
+
+// Projective map of the plane, x' = (ax + by + c) / (gx + hy + 1)
+struct Homography
+{
+    double a = 1, b = 0, c = 0;
+    double d = 0, e = 1, f = 0;
+    double g = 0, h = 0;
+
+    Point Map(double x, double y) const
+    {
+        auto w = g * x + h * y + 1;
+        return Point{static_cast<float>((a * x + b * y + c) / w),
+                     static_cast<float>((d * x + e * y + f) / w)};
+    }
+};
+
+// Maps the corners of the `width` x `height` image, (0, 0) to
+// (width - 1, height - 1), onto `quad`
+Homography RectToQuad(const Quad &quad, int width, int height);
+
+// Size of the straightened quad: its longer opposite edges, as
+// fix_perspective does
+void StraightSize(const Quad &quad, int &width, int &height);
+
+// Perspective of the quad: how much shorter the shorter of two opposite
+// edges is, the larger of both pairs. 0 for a sheet shot straight on.
+float Tilt(const Quad &quad);
+
+// The quad straightened to `width` x `height`, bilinear, the edge pixels
+// repeated outside of the plane. The work is per output pixel: the
+// source is only sampled, its size does not matter. With a pool, strips
+// of rows are warped on the workers and the calling thread.
+Image Warp(const Plane &src, const Quad &quad, int width, int height, ThreadPool *pool = nullptr);
+
+} // namespace omr
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_OMR_WARP_H */
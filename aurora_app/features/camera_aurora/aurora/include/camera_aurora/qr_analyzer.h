@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_QR_ANALYZER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_QR_ANALYZER_H
+
+#include <camera_aurora/frame_analyzer.h>
+
+#include <functional>
+#include <vector>
+
+// Searches QR codes on the Y plane, frames larger than 720p are
+// downscaled first. Reports the text, or "" when nothing is found.
+class QrAnalyzer final : public FrameAnalyzer
+{
+public:
+    typedef std::function<void(std::string)> Handler;
+
+    static constexpr auto AnalyzerName = "qr";
+
+    explicit QrAnalyzer(const Handler &onResult);
+
+    std::string Name() const override;
+    void Analyze(const FrameView &frame) override;
+
+private:
+    Handler m_onResult;
+    std::vector<uint8_t> m_scaled;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_QR_ANALYZER_H */
@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_SERIAL_QUEUE_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_SERIAL_QUEUE_H
+
+#include <camera_aurora/thread_pool.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+// Tasks posted to one queue run one by one in order, on the threads of a
+// shared pool. Queues take turns: a queue runs one task and goes to the
+// back of the pool, so a slow camera does not hold up the others.
+// Copies share the same queue.
+class SerialQueue
+{
+public:
+    explicit SerialQueue(ThreadPool *pool);
+
+    void Post(ThreadPool::Task task);
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        std::deque<ThreadPool::Task> tasks;
+        bool running = false;
+    };
+
+    static void RunNext(ThreadPool *pool, std::shared_ptr<State> state);
+
+private:
+    ThreadPool *m_pool;
+    std::shared_ptr<State> m_state;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_SERIAL_QUEUE_H */
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_SHEET_ANALYZER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_SHEET_ANALYZER_H
+
+#include <camera_aurora/frame_analyzer.h>
+#include <camera_aurora/omr/image.h>
+#include <camera_aurora/omr/tracker.h>
+
+#include <functional>
+
+// Finds the answer table on preview frames: the corners of the omr
+// pipeline on a small copy of the Y plane, and how still they are.
+// A lost table is reported once, not on every frame.
+class SheetAnalyzer final : public FrameAnalyzer
+{
+public:
+    // Corners are shares of the frame width and height, in the
+    // orientation of the frame as the preview texture shows it
+    struct Sheet
+    {
+        bool found = false;
+        omr::Quad corners;
+        float jitter = 0;
+        float stability = 0;
+        float tilt = 0;        // omr::Tilt of the corners in pixels
+        double sharpness = 0;  // yuv::Sharpness inside the corners' box
+        int64_t sequence = 0;
+    };
+
+    typedef std::function<void(const Sheet &)> Handler;
+
+    static constexpr auto AnalyzerName = "sheet";
+
+    // Long edge of the searched copy
+    static constexpr int SearchSize = 480;
+
+    // About 12 frames a second
+    static constexpr std::chrono::milliseconds Interval{80};
+
+    // Stability is measured over the last `frames` frames
+    explicit SheetAnalyzer(const Handler &onSheet, size_t frames = omr::QuadTracker::DefaultFrames);
+
+    std::string Name() const override;
+    void Analyze(const FrameView &frame) override;
+
+private:
+    Handler m_onSheet;
+    omr::QuadTracker m_tracker;
+    bool m_lost = false;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_SHEET_ANALYZER_H */
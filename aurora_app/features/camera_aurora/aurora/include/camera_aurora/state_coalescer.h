@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_STATE_COALESCER_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_STATE_COALESCER_H
+
+#include <camera_aurora/encodable_helper.h>
+
+// Keeps the latest camera state snapshot and the one last sent, so a burst
+// of changes is sent as one delta. Not thread-safe, used on the platform
+// thread only.
+class StateCoalescer
+{
+public:
+    // Replace the pending snapshot, the latest one wins
+    void Merge(const EncodableMap &state);
+
+    // Fields of the pending snapshot that differ from the sent one; fields
+    // that disappeared are sent as null. Empty if nothing changed.
+    EncodableMap TakeDelta();
+
+    // Forget the sent snapshot, the next delta is the full state
+    void Reset();
+
+private:
+    EncodableMap m_pending;
+    EncodableMap m_sent;
+    bool m_hasPending = false;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_STATE_COALESCER_H */
@@ -5,50 +5,121 @@
 #ifndef TEXTURE_CAMERA_BUFFER_H
 #define TEXTURE_CAMERA_BUFFER_H
 
+#include <camera_aurora/auto_capture.h>
+#include <camera_aurora/capture_timeline.h>
 #include <camera_aurora/encodable_helper.h>
+#include <camera_aurora/frame_analyzer.h>
+#include <camera_aurora/frame_budget.h>
+#include <camera_aurora/frame_ring.h>
+#include <camera_aurora/frame_stats.h>
+#include <camera_aurora/frame_stream.h>
+#include <camera_aurora/omr/grader.h>
+#include <camera_aurora/sheet_analyzer.h>
+#include <camera_aurora/thread_pool.h>
+#include <camera_aurora/yuv_output.h>
 
 #include <flutter/flutter_aurora.h>
 #include <flutter/encodable_value.h>
 #include <flutter/texture_registrar.h>
 
 #include <streamcamera/streamcamera.h>
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <optional>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 typedef flutter::TextureVariant TextureVariant;
 typedef flutter::TextureRegistrar TextureRegistrar;
 typedef flutter::PixelBufferTexture PixelBufferTexture;
 
-typedef std::function<void()> CameraErrorHandler;
+// Events carry the camera ID, the texture ID given by Register
+typedef std::function<void(int64_t)> CameraErrorHandler;
 typedef std::function<void(std::string)> TakeImageBase64Handler;
-typedef std::function<void(std::string)> ChangeQRHandler;
-
-class TextureCamera : public Aurora::StreamCamera::CameraListener
+typedef std::function<void(int64_t, std::string)> ChangeQRHandler;
+typedef std::function<void(const CaptureTimeline &, std::string)> CaptureHandler;
+typedef std::function<void(int64_t, const CaptureTimeline &, std::string)> CaptureResultHandler;
+typedef std::function<void(int64_t, const FrameStream::Frame &)> FrameStreamHandler;
+typedef std::function<void(const omr::Result &)> GradeHandler;
+typedef std::function<void(int64_t, const SheetAnalyzer::Sheet &)> SheetHandler;
+
+class TextureCamera
+    : public Aurora::StreamCamera::CameraListener
+    , public std::enable_shared_from_this<TextureCamera>
 {
 public:
     TextureCamera(flutter::TextureRegistrar* texture_registrar,
+                  ThreadPool* pool,
+                  FrameBudget* budget,
                   const CameraErrorHandler &onError,
-                  const ChangeQRHandler &onChangeQR);
+                  const ChangeQRHandler &onChangeQR,
+                  const CaptureResultHandler &onCaptureResult,
+                  const FrameStreamHandler &onStreamFrame);
 
     void onCameraError(const std::string &errorDescription) override;
     void onCameraFrame(std::shared_ptr<Aurora::StreamCamera::GraphicBuffer> buffer) override;
     void onCameraParameterChanged(Aurora::StreamCamera::CameraParameter,
                                   const std::string &value) override;
 
-    EncodableList GetAvailableCameras();
+    static EncodableList GetAvailableCameras();
     EncodableMap Register(std::string cameraName);
     EncodableMap Unregister();
     EncodableMap StartCapture(int width, int height);
     void StopCapture();
     EncodableMap GetState();
-    void GetImageBase64(const TakeImageBase64Handler &takeImageBase64);
+    int64_t CameraId() const;
+    std::string CameraName() const;
+    void GetImageBase64(const CaptureHandler &takeImageBase64);
+    void GetProgressiveImageBase64(int thumbnail, const CaptureHandler &takeThumbnail);
+    void GetBurstImageBase64(int count, int interval, const TakeImageBase64Handler &takeBurst);
+    void GradeSheet(const omr::AnswerKey &key,
+                    const std::shared_ptr<const omr::CompiledLayout> &layout,
+                    const GradeHandler &onGrade);
     EncodableMap ResizeFrame(int width, int height);
     void EnableSearchQr(bool state);
+    void AddAnalyzer(const std::shared_ptr<FrameAnalyzer> &analyzer,
+                     std::chrono::milliseconds interval);
+    void RemoveAnalyzer(const std::string &name);
+    void SetSheetHandler(const SheetHandler &onSheet);
+    void SetAutoCapture(const AutoCapture::Options &options);
+    std::shared_ptr<FrameStats> Stats() const;
+    void SetPreCapture(int frames);
+    void SetOutput(const yuv::OutputOptions &options);
+    void StartImageStream(const FrameStream::Options &options);
+    void StopImageStream();
+    void ReleaseFrame(int slot, int64_t sequence);
+    bool IsImageStream() const;
+    // Outlives the camera while Dart holds its frames
+    std::shared_ptr<FrameStream> ImageStream() const;
 
 private:
-    void SearchQr(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame);
+    // What a caller asked of the camera thread, copied by it under m_requestMutex
+    struct CaptureRequest
+    {
+        CaptureHandler handler;
+        CaptureTimeline timeline;
+        FrameRing::Clock::time_point time; // of the tap, the pre-capture ring is searched back from it
+        int thumbnail = 0;
+    };
+
+    struct GradeRequest
+    {
+        omr::AnswerKey key;
+        std::shared_ptr<const omr::CompiledLayout> layout; // null: the grid is searched
+        GradeHandler handler;
+        FrameRing::Clock::time_point time;
+    };
+
+    // The texture's pixels with their size, swapped whole for the raster thread
+    struct Preview
+    {
+        std::shared_ptr<uint8_t> bits;
+        int width;
+        int height;
+    };
+
     bool CreateCamera(std::string cameraName);
     void SendError(std::string error);
     void ResizeFrame(int width,
@@ -57,16 +128,52 @@ private:
                      Aurora::StreamCamera::CameraCapability cap,
                      int &captureWidth,
                      int &captureHeight);
+    void RequestSize(int width, int height);
+    yuv::OutputOptions Output();
     std::optional<std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame>> GetFrame(
         std::shared_ptr<Aurora::StreamCamera::GraphicBuffer> buffer);
+    std::string TakeImageBase64(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                                FrameRing::Clock::time_point time);
+    std::string Encode(const uint8_t *y,
+                       int strideY,
+                       const uint8_t *u,
+                       const uint8_t *v,
+                       int width,
+                       int height,
+                       int orientation,
+                       int mountAngle,
+                       int direction,
+                       const yuv::OutputOptions &options);
+    void TakeBurstFrame(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame);
+    void TakeProgressive(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                         const CaptureRequest &request);
+    void TakeGrade(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                   const GradeRequest &request);
+    void TakeAuto(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                  const CaptureTimeline &timeline,
+                  FrameRing::Clock::time_point time);
+    std::shared_ptr<uint8_t> CopyCapture(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                                         FrameRing::Clock::time_point time,
+                                         int &width,
+                                         int &height);
+    void EncodeCapture(const CaptureTimeline &timeline,
+                       std::shared_ptr<uint8_t> buf,
+                       int width,
+                       int height);
+    void UpdateSheetAnalyzer();
+    void OnSheet(const SheetAnalyzer::Sheet &sheet);
 
 private:
     TextureRegistrar* m_textures;
+    ThreadPool* m_pool;
+    FrameBudget* m_budget;
+    FrameBudget::Account m_budgetAccount;
     std::shared_ptr<TextureVariant> m_textureVariant;
 
-    TakeImageBase64Handler m_takeImageBase64;
     CameraErrorHandler m_onError;
     ChangeQRHandler m_onChangeQR;
+    CaptureResultHandler m_onCaptureResult;
+    FrameStreamHandler m_onStreamFrame;
     std::string m_error;
 
     Aurora::StreamCamera::CameraInfo m_info;
@@ -77,18 +184,56 @@ private:
     std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> m_frame;
 
     int64_t m_textureId = 0;
-    int m_captureWidth = 0;
+    int64_t m_cameraId = 0;
+    std::string m_cameraName;
+    int m_captureWidth = 0; // the camera thread's, callers go through m_requestWidth
     int m_captureHeight = 0;
     int m_viewWidth = 0;
     int m_viewHeight = 0;
 
-    std::shared_ptr<uint8_t> m_bits;
+    FrameRing m_preCapture;
+
+    // Callers run on the platform thread and the device's queue, the
+    // camera thread takes their requests when the flags are set. A
+    // request of each kind may be pending at once.
+    std::mutex m_requestMutex;
+    CaptureRequest m_still;
+    CaptureRequest m_progressive;
+    GradeRequest m_grade;
+    yuv::OutputOptions m_output;
+    int m_requestWidth = 0;
+    int m_requestHeight = 0;
+
+    // Sheet reports and the auto capture share one analyzer
+    std::mutex m_sheetMutex;
+    SheetHandler m_onSheet;
+    AutoCapture m_autoCapture;
+    bool m_isSheetAnalyzer = false;
+    CaptureTimeline m_autoTimeline;
+    FrameRing::Clock::time_point m_autoTime; // of the trigger, taps carry their own
+    std::atomic<bool> m_isTakeAuto{false};
+
+    std::shared_ptr<FrameStream> m_stream;
+    std::shared_ptr<FrameStats> m_stats;
+    std::atomic<int64_t> m_availableAt{0};
+    FrameAnalyzers m_analyzers;
+    int64_t m_sequence = 0;
+
+    FrameRing m_burst;
+    TakeImageBase64Handler m_takeBurst; // under m_requestMutex with the two below
+    FrameRing::Clock::time_point m_burstNext;
+    std::chrono::milliseconds m_burstInterval{0};
+
+    std::shared_ptr<const Preview> m_preview; // std::atomic_load and std::atomic_store only
     int m_counter = 0;
-    int m_counter_qr = 0;
-    int m_chromaStep = 1;
-    bool m_isStart = false;
-    bool m_isTakeImageBase64 = false;
-    bool m_enableSearchQr = false;
+    std::atomic<int> m_chromaStep{1};
+    std::atomic<bool> m_isStart{false};
+    std::atomic<bool> m_isResize{false};
+    std::atomic<bool> m_isTakeImageBase64{false};
+    std::atomic<bool> m_isTakeProgressive{false};
+    std::atomic<bool> m_isGrade{false};
+    std::atomic<bool> m_isTakeBurst{false};
+    std::atomic<bool> m_isBurstBusy{false}; // cleared on the workers
 };
 
 #endif /* TEXTURE_CAMERA_BUFFER_H */
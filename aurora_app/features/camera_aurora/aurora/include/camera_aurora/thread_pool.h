@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_THREAD_POOL_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the plugin.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // 0 - one thread per core
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void Post(Task task);
+
+    // Run body(0..count-1) on the workers and the calling thread,
+    // returns when all the iterations are done.
+    void ParallelFor(size_t count, const std::function<void(size_t)> &body);
+
+    size_t Size() const;
+
+private:
+    void Run();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<Task> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop = false;
+};
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_THREAD_POOL_H */
@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_TRACE_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_TRACE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Opt-in tracing of spans and counters, saved as Chrome Trace Event
+// JSON for Perfetto or chrome://tracing. Every thread writes to its own
+// ring, preallocated by Start, the oldest events are overwritten; nothing
+// is allocated or written to disk while recording, unless more than 16
+// threads record. Names must outlive the
+// trace: string literals or strings owned for the plugin lifetime.
+namespace trace {
+
+// Events kept per thread
+constexpr size_t DefaultCapacity = 16384;
+
+// Starting drops the events of the previous session
+void Start(size_t capacity = DefaultCapacity);
+void Stop();
+bool IsEnabled();
+
+// Label of the calling thread in the trace, the first one set is kept
+void NameThread(const char *name);
+
+void Counter(const char *name, int64_t value);
+
+// Writes the events of all the threads, false on I/O error
+bool Dump(const std::string &path);
+
+// Records the time between construction and destruction as one span
+class Scope
+{
+public:
+    explicit Scope(const char *name);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    int64_t m_begin;
+};
+
+} // namespace trace
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_TRACE_H */
@@ -5,22 +5,31 @@
 #ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_H
 #define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_H
 
+#include <camera_aurora/binarize.h>
+#include <camera_aurora/jpeg_encoder.h>
+#include <camera_aurora/yuv_output.h>
+
 #include <libyuv/libyuv.h>
 
 #include <QBuffer>
 #include <QImage>
 #include <QtCore>
 
+#include <cstring>
+
 namespace yuv {
 
-std::string YUVToBase64(const uint8_t *srcY,
-                        const uint8_t *srcU,
-                        const uint8_t *srcV,
-                        int srcWidth,
-                        int srcHeight,
-                        int orientationDisplay,
-                        int orientationCamera,
-                        int direction)
+// The quality QImage::save uses by default
+constexpr int JpegQuality = 75;
+
+inline std::string ToBase64(const std::vector<uint8_t> &data)
+{
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(data.data()), data.size())
+        .toBase64()
+        .toStdString();
+}
+
+inline int RotationAngle(int orientationDisplay, int orientationCamera, int direction)
 {
     auto angle = orientationCamera - orientationDisplay;
 
@@ -36,41 +45,175 @@ std::string YUVToBase64(const uint8_t *srcY,
         angle = angle % 360;
     }
 
-    QSize size(srcWidth, srcHeight);
-    QImage image(size, QImage::Format_RGBA8888);
+    return angle;
+}
+
+// Colour output: the planes are rotated by libyuv and encoded straight
+// from I420 by the strip encoder, in parallel when a pool is given.
+// Callers pass the camera's Cr plane as `srcU` and Cb as `srcV`, the
+// order the preview takes them in.
+inline std::string YUVToBase64(const uint8_t *srcY,
+                               const uint8_t *srcU,
+                               const uint8_t *srcV,
+                               int srcWidth,
+                               int srcHeight,
+                               int orientationDisplay,
+                               int orientationCamera,
+                               int direction,
+                               ThreadPool *pool = nullptr)
+{
+    auto angle = RotationAngle(orientationDisplay, orientationCamera, direction);
+
+    auto width = angle == 90 || angle == 270 ? srcHeight : srcWidth;
+    auto height = angle == 90 || angle == 270 ? srcWidth : srcHeight;
+
+    auto strideUV = (width + 1) / 2;
+    auto sizeY = width * height;
+    auto sizeUV = strideUV * ((height + 1) / 2);
+
+    auto buf = std::shared_ptr<uint8_t>((uint8_t *) malloc(sizeY + sizeUV * 2), free);
+
+    auto y = buf.get();
+    auto u = y + sizeY;
+    auto v = u + sizeUV;
 
     if (srcV) {
-        auto srcStrideY = srcWidth;
-        auto srcStrideU = (srcWidth + 1) / 2;
-        auto srcStrideV = srcStrideU;
+        auto srcStrideUV = (srcWidth + 1) / 2;
 
-        libyuv::I420ToARGB(srcY,
-                           srcStrideY,
+        libyuv::I420Rotate(srcY,
+                           srcWidth,
                            srcU,
-                           srcStrideU,
+                           srcStrideUV,
                            srcV,
-                           srcStrideV,
-                           reinterpret_cast<uint8_t *>(image.bits()),
-                           srcWidth * 4,
+                           srcStrideUV,
+                           y,
+                           width,
+                           u,
+                           strideUV,
+                           v,
+                           strideUV,
                            srcWidth,
-                           srcHeight);
+                           srcHeight,
+                           static_cast<libyuv::RotationMode>(angle));
     } else {
-        auto srcStrideY = srcWidth;
-        auto srcStrideUV = srcWidth;
+        libyuv::NV12ToI420Rotate(srcY,
+                                 srcWidth,
+                                 srcU, // UV
+                                 srcWidth,
+                                 y,
+                                 width,
+                                 u,
+                                 strideUV,
+                                 v,
+                                 strideUV,
+                                 srcWidth,
+                                 srcHeight,
+                                 static_cast<libyuv::RotationMode>(angle));
+    }
 
-        libyuv::NV12ToARGB(srcY,
-                           srcStrideY,
-                           srcU, // UV
-                           srcStrideUV,
-                           reinterpret_cast<uint8_t *>(image.bits()),
-                           srcWidth * 4,
-                           srcWidth,
-                           srcHeight);
+    // The preview swaps them back by reading BGRA as RGBA, the encoder
+    // takes the planes by name
+    auto cr = u;
+    auto cb = v;
+
+    return ToBase64(jpeg::Encode({y, width, cb, strideUV, cr, strideUV, width, height},
+                                 JpegQuality,
+                                 pool));
+}
+
+// Document output: only the Y plane is used, it is box-downscaled and
+// rotated by libyuv and saved as a grayscale JPEG or a 1-bit PNG.
+inline std::string YToBase64(const uint8_t *srcY,
+                             int srcStrideY,
+                             int srcWidth,
+                             int srcHeight,
+                             int orientationDisplay,
+                             int orientationCamera,
+                             int direction,
+                             const OutputOptions &options,
+                             ThreadPool *pool = nullptr)
+{
+    auto angle = RotationAngle(orientationDisplay, orientationCamera, direction);
+
+    auto width = srcWidth;
+    auto height = srcHeight;
+    auto longEdge = std::max(srcWidth, srcHeight);
+
+    if (options.longEdge > 0 && options.longEdge < longEdge) {
+        width = std::max(1, srcWidth * options.longEdge / longEdge);
+        height = std::max(1, srcHeight * options.longEdge / longEdge);
+    }
+
+    auto scaled = std::shared_ptr<uint8_t>((uint8_t *) malloc(width * height), free);
+
+    libyuv::ScalePlane(srcY,
+                       srcStrideY,
+                       srcWidth,
+                       srcHeight,
+                       scaled.get(),
+                       width,
+                       width,
+                       height,
+                       libyuv::kFilterBox);
+
+    auto rotated = scaled;
+    auto outWidth = angle == 90 || angle == 270 ? height : width;
+    auto outHeight = angle == 90 || angle == 270 ? width : height;
+
+    if (angle != 0) {
+        rotated = std::shared_ptr<uint8_t>((uint8_t *) malloc(width * height), free);
+        libyuv::RotatePlane(scaled.get(),
+                            width,
+                            rotated.get(),
+                            outWidth,
+                            width,
+                            height,
+                            static_cast<libyuv::RotationMode>(angle));
+    }
+
+    if (options.format != OutputFormat::Binary) {
+        return ToBase64(jpeg::Encode({rotated.get(), outWidth, nullptr, 0, nullptr, 0, outWidth, outHeight},
+                                     JpegQuality,
+                                     pool,
+                                     options.dpi));
+    }
+
+    auto binary = std::shared_ptr<uint8_t>((uint8_t *) malloc(outWidth * outHeight), free);
+
+    binarize::AdaptiveThreshold(rotated.get(),
+                                outWidth,
+                                binary.get(),
+                                outWidth,
+                                outWidth,
+                                outHeight,
+                                std::max(outWidth, outHeight) / 32 | 1,
+                                10);
+
+    QImage image(QSize(outWidth, outHeight), QImage::Format_Mono);
+    image.setColorCount(2);
+    image.setColor(0, qRgb(0, 0, 0));
+    image.setColor(1, qRgb(255, 255, 255));
+
+    for (int y = 0; y < outHeight; y++) {
+        auto src = binary.get() + y * outWidth;
+        auto dst = image.scanLine(y);
+        memset(dst, 0, image.bytesPerLine());
+        for (int x = 0; x < outWidth; x++) {
+            if (src[x]) {
+                dst[x >> 3] |= 0x80 >> (x & 7);
+            }
+        }
+    }
+
+    if (options.dpi > 0) {
+        auto dpm = static_cast<int>(options.dpi / 0.0254);
+        image.setDotsPerMeterX(dpm);
+        image.setDotsPerMeterY(dpm);
     }
 
     QBuffer qbuffer;
     qbuffer.open(QIODevice::WriteOnly);
-    image.transformed(QMatrix().rotate(angle)).save(&qbuffer, "JPEG");
+    image.save(&qbuffer, "PNG");
 
     return qbuffer.data().toBase64().toStdString();
 }
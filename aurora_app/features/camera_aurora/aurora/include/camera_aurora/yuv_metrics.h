@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_METRICS_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_METRICS_H
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace yuv {
+
+// Focus metric: mean squared 4-neighbour Laplacian over the central part
+// of the Y plane, sampled every `step` pixels. Bigger is sharper.
+inline double Sharpness(const uint8_t *srcY, int strideY, int width, int height, int step = 4)
+{
+    auto x0 = width / 8 + 1;
+    auto y0 = height / 8 + 1;
+    auto x1 = width - width / 8 - 1;
+    auto y1 = height - height / 8 - 1;
+
+    uint64_t sum = 0;
+    uint64_t count = 0;
+
+    for (auto y = y0; y < y1; y += step) {
+        auto row = srcY + y * strideY;
+        for (auto x = x0; x < x1; x += step) {
+            int lap = row[x - 1] + row[x + 1] + row[x - strideY] + row[x + strideY]
+                      - 4 * row[x];
+            sum += static_cast<uint64_t>(lap * lap);
+            count++;
+        }
+    }
+
+    return count ? static_cast<double>(sum) / count : 0.0;
+}
+
+// Part of the Y plane samples that are crushed to black or blown to white.
+inline double Clipping(const uint8_t *srcY, int strideY, int width, int height, int step = 4)
+{
+    uint64_t clipped = 0;
+    uint64_t count = 0;
+
+    for (auto y = 0; y < height; y += step) {
+        auto row = srcY + y * strideY;
+        for (auto x = 0; x < width; x += step) {
+            clipped += (row[x] <= 4 || row[x] >= 251) ? 1 : 0;
+            count++;
+        }
+    }
+
+    return count ? static_cast<double>(clipped) / count : 0.0;
+}
+
+// Burst frame score: sharpness penalised by exposure clipping.
+inline double FrameScore(const uint8_t *srcY, int strideY, int width, int height)
+{
+    auto clipping = Clipping(srcY, strideY, width, height);
+    auto penalty = 1.0 - 2.0 * clipping;
+    return Sharpness(srcY, strideY, width, height) * (penalty < 0 ? 0 : penalty);
+}
+
+} // namespace yuv
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_METRICS_H */
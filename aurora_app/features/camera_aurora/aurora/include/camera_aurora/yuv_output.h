@@ -0,0 +1,26 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_OUTPUT_H
+#define FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_OUTPUT_H
+
+namespace yuv {
+
+enum class OutputFormat
+{
+    Jpeg,   // colour JPEG
+    Gray,   // 8-bit grayscale JPEG from the Y plane
+    Binary, // 1-bit adaptively binarised PNG from the Y plane
+};
+
+struct OutputOptions
+{
+    OutputFormat format = OutputFormat::Jpeg;
+    int longEdge = 0; // downscale the long edge to, 0 - keep the sensor size
+    int dpi = 0;      // resolution written to the file, 0 - not set
+};
+
+} // namespace yuv
+
+#endif /* FLUTTER_PLUGIN_CAMERA_AURORA_PLUGIN_YUV_OUTPUT_H */
@@ -0,0 +1,531 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/jpeg_encoder.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace jpeg {
+
+namespace {
+
+// Natural index of the k-th coefficient in zigzag order
+const uint8_t ZigZag[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// ITU T.81 Annex K tables
+const uint8_t LumaQuant[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,
+    12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,
+    14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,
+    24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+const uint8_t ChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+const uint8_t LumaDcBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const uint8_t ChromaDcBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const uint8_t DcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const uint8_t LumaAcBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const uint8_t LumaAcValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61,
+    0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52,
+    0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25,
+    0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45,
+    0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64,
+    0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+    0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+    0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3,
+    0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8,
+    0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa,
+};
+
+const uint8_t ChromaAcBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const uint8_t ChromaAcValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61,
+    0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33,
+    0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18,
+    0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44,
+    0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63,
+    0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a,
+    0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+    0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+    0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca,
+    0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7,
+    0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa,
+};
+
+// AAN DCT output scale factors, times sqrt(8)
+const float AanScale[8] = {
+    1.0f * 2.828427125f,
+    1.387039845f * 2.828427125f,
+    1.306562965f * 2.828427125f,
+    1.175875602f * 2.828427125f,
+    1.0f * 2.828427125f,
+    0.785694958f * 2.828427125f,
+    0.541196100f * 2.828427125f,
+    0.275899379f * 2.828427125f,
+};
+
+struct HuffmanTable
+{
+    uint16_t codes[256];
+    uint8_t sizes[256];
+
+    HuffmanTable(const uint8_t *bits, const uint8_t *values)
+    {
+        std::fill(codes, codes + 256, 0);
+        std::fill(sizes, sizes + 256, 0);
+
+        uint16_t code = 0;
+        auto index = 0;
+
+        for (auto length = 1; length <= 16; length++) {
+            for (auto count = 0; count < bits[length - 1]; count++) {
+                codes[values[index]] = code++;
+                sizes[values[index]] = static_cast<uint8_t>(length);
+                index++;
+            }
+            code <<= 1;
+        }
+    }
+};
+
+const HuffmanTable &LumaDc()
+{
+    static const HuffmanTable table(LumaDcBits, DcValues);
+    return table;
+}
+
+const HuffmanTable &LumaAc()
+{
+    static const HuffmanTable table(LumaAcBits, LumaAcValues);
+    return table;
+}
+
+const HuffmanTable &ChromaDc()
+{
+    static const HuffmanTable table(ChromaDcBits, DcValues);
+    return table;
+}
+
+const HuffmanTable &ChromaAc()
+{
+    static const HuffmanTable table(ChromaAcBits, ChromaAcValues);
+    return table;
+}
+
+struct Quantizer
+{
+    uint8_t table[64];   // natural order, as written in DQT
+    float divisors[64];  // natural order, AAN scale folded in
+
+    Quantizer(const uint8_t *base, int quality)
+    {
+        quality = std::clamp(quality, 1, 100);
+        auto scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+        for (auto index = 0; index < 64; index++) {
+            auto value = std::clamp((base[index] * scale + 50) / 100, 1, 255);
+            table[index] = static_cast<uint8_t>(value);
+            divisors[index] = 1.0f / (value * AanScale[index / 8] * AanScale[index % 8]);
+        }
+    }
+};
+
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t> &out)
+        : m_out(out)
+    {}
+
+    void Write(uint32_t bits, int count)
+    {
+        m_buffer = (m_buffer << count) | (bits & ((1u << count) - 1));
+        m_count += count;
+
+        while (m_count >= 8) {
+            auto byte = static_cast<uint8_t>(m_buffer >> (m_count - 8));
+            m_out.push_back(byte);
+            if (byte == 0xff) {
+                m_out.push_back(0);
+            }
+            m_count -= 8;
+        }
+    }
+
+    // Pad the last byte with ones, as required before a marker
+    void Flush()
+    {
+        if (m_count > 0) {
+            Write(0x7f, 8 - m_count);
+        }
+        m_buffer = 0;
+    }
+
+private:
+    std::vector<uint8_t> &m_out;
+    uint32_t m_buffer = 0;
+    int m_count = 0;
+};
+
+void ForwardDct(float *data, int step)
+{
+    float tmp0 = data[0] + data[7 * step];
+    float tmp7 = data[0] - data[7 * step];
+    float tmp1 = data[step] + data[6 * step];
+    float tmp6 = data[step] - data[6 * step];
+    float tmp2 = data[2 * step] + data[5 * step];
+    float tmp5 = data[2 * step] - data[5 * step];
+    float tmp3 = data[3 * step] + data[4 * step];
+    float tmp4 = data[3 * step] - data[4 * step];
+
+    // Even part
+    float tmp10 = tmp0 + tmp3;
+    float tmp13 = tmp0 - tmp3;
+    float tmp11 = tmp1 + tmp2;
+    float tmp12 = tmp1 - tmp2;
+
+    data[0] = tmp10 + tmp11;
+    data[4 * step] = tmp10 - tmp11;
+
+    float z1 = (tmp12 + tmp13) * 0.707106781f;
+    data[2 * step] = tmp13 + z1;
+    data[6 * step] = tmp13 - z1;
+
+    // Odd part
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    float z5 = (tmp10 - tmp12) * 0.382683433f;
+    float z2 = tmp10 * 0.541196100f + z5;
+    float z4 = tmp12 * 1.306562965f + z5;
+    float z3 = tmp11 * 0.707106781f;
+
+    float z11 = tmp7 + z3;
+    float z13 = tmp7 - z3;
+
+    data[5 * step] = z13 + z2;
+    data[3 * step] = z13 - z2;
+    data[step] = z11 + z4;
+    data[7 * step] = z11 - z4;
+}
+
+// Load an 8x8 block replicating the plane edges
+void LoadBlock(const uint8_t *plane, int stride, int width, int height, int x, int y, float *block)
+{
+    for (auto row = 0; row < 8; row++) {
+        auto line = plane + std::min(y + row, height - 1) * stride;
+        if (x + 8 <= width) {
+            for (auto col = 0; col < 8; col++) {
+                block[row * 8 + col] = line[x + col] - 128.0f;
+            }
+        } else {
+            for (auto col = 0; col < 8; col++) {
+                block[row * 8 + col] = line[std::min(x + col, width - 1)] - 128.0f;
+            }
+        }
+    }
+}
+
+void EncodeValue(BitWriter &writer, int value, const HuffmanTable &table, int symbolRun)
+{
+    auto magnitude = value < 0 ? -value : value;
+    auto size = 0;
+
+    while (magnitude) {
+        size++;
+        magnitude >>= 1;
+    }
+
+    auto symbol = (symbolRun << 4) | size;
+    writer.Write(table.codes[symbol], table.sizes[symbol]);
+
+    if (size) {
+        writer.Write(static_cast<uint32_t>(value < 0 ? value - 1 : value), size);
+    }
+}
+
+void EncodeBlock(BitWriter &writer,
+                 float *block,
+                 const Quantizer &quantizer,
+                 const HuffmanTable &dc,
+                 const HuffmanTable &ac,
+                 int &predictor)
+{
+    for (auto row = 0; row < 8; row++) {
+        ForwardDct(block + row * 8, 1);
+    }
+
+    for (auto col = 0; col < 8; col++) {
+        ForwardDct(block + col, 8);
+    }
+
+    int coefficients[64];
+
+    for (auto index = 0; index < 64; index++) {
+        auto natural = ZigZag[index];
+        coefficients[index] = static_cast<int>(std::lround(block[natural] * quantizer.divisors[natural]));
+    }
+
+    EncodeValue(writer, coefficients[0] - predictor, dc, 0);
+    predictor = coefficients[0];
+
+    auto last = 63;
+    while (last > 0 && coefficients[last] == 0) {
+        last--;
+    }
+
+    auto run = 0;
+
+    for (auto index = 1; index <= last; index++) {
+        if (coefficients[index] == 0) {
+            run++;
+            continue;
+        }
+        while (run > 15) {
+            writer.Write(ac.codes[0xf0], ac.sizes[0xf0]); // ZRL
+            run -= 16;
+        }
+        EncodeValue(writer, coefficients[index], ac, run);
+        run = 0;
+    }
+
+    if (last < 63) {
+        writer.Write(ac.codes[0x00], ac.sizes[0x00]); // EOB
+    }
+}
+
+struct Layout
+{
+    int mcuSize;
+    int mcusX;
+    int mcusY;
+    bool color;
+};
+
+void EncodeRows(const Planes &planes,
+                const Layout &layout,
+                const Quantizer &luma,
+                const Quantizer &chroma,
+                int rowBegin,
+                int rowEnd,
+                std::vector<uint8_t> &out)
+{
+    BitWriter writer(out);
+    float block[64];
+
+    auto chromaWidth = (planes.width + 1) / 2;
+    auto chromaHeight = (planes.height + 1) / 2;
+
+    for (auto row = rowBegin; row < rowEnd; row++) {
+        // Predictors restart at every MCU row
+        int predictorY = 0;
+        int predictorU = 0;
+        int predictorV = 0;
+
+        for (auto col = 0; col < layout.mcusX; col++) {
+            auto x = col * layout.mcuSize;
+            auto y = row * layout.mcuSize;
+
+            if (!layout.color) {
+                LoadBlock(planes.y, planes.strideY, planes.width, planes.height, x, y, block);
+                EncodeBlock(writer, block, luma, LumaDc(), LumaAc(), predictorY);
+                continue;
+            }
+
+            for (auto index = 0; index < 4; index++) {
+                LoadBlock(planes.y,
+                          planes.strideY,
+                          planes.width,
+                          planes.height,
+                          std::min(x + (index & 1) * 8, planes.width - 1),
+                          std::min(y + (index >> 1) * 8, planes.height - 1),
+                          block);
+                EncodeBlock(writer, block, luma, LumaDc(), LumaAc(), predictorY);
+            }
+
+            LoadBlock(planes.u, planes.strideU, chromaWidth, chromaHeight, x / 2, y / 2, block);
+            EncodeBlock(writer, block, chroma, ChromaDc(), ChromaAc(), predictorU);
+
+            LoadBlock(planes.v, planes.strideV, chromaWidth, chromaHeight, x / 2, y / 2, block);
+            EncodeBlock(writer, block, chroma, ChromaDc(), ChromaAc(), predictorV);
+        }
+
+        writer.Flush();
+
+        if (row + 1 < layout.mcusY) {
+            out.push_back(0xff);
+            out.push_back(static_cast<uint8_t>(0xd0 + (row & 7))); // RSTn
+        }
+    }
+}
+
+void PutMarker(std::vector<uint8_t> &out, uint8_t marker, int length)
+{
+    out.push_back(0xff);
+    out.push_back(marker);
+    out.push_back(static_cast<uint8_t>(length >> 8));
+    out.push_back(static_cast<uint8_t>(length & 0xff));
+}
+
+void PutQuant(std::vector<uint8_t> &out, int id, const Quantizer &quantizer)
+{
+    out.push_back(static_cast<uint8_t>(id));
+    for (auto index = 0; index < 64; index++) {
+        out.push_back(quantizer.table[ZigZag[index]]);
+    }
+}
+
+void PutHuffman(std::vector<uint8_t> &out, int id, const uint8_t *bits, const uint8_t *values)
+{
+    auto count = 0;
+
+    out.push_back(static_cast<uint8_t>(id));
+    for (auto index = 0; index < 16; index++) {
+        out.push_back(bits[index]);
+        count += bits[index];
+    }
+    out.insert(out.end(), values, values + count);
+}
+
+void PutHeader(std::vector<uint8_t> &out,
+               const Planes &planes,
+               const Layout &layout,
+               const Quantizer &luma,
+               const Quantizer &chroma,
+               int dpi)
+{
+    auto components = layout.color ? 3 : 1;
+    auto density = static_cast<uint8_t>(dpi > 0 ? 1 : 0);
+    auto densityHigh = static_cast<uint8_t>(dpi > 0 ? (dpi >> 8) & 0xff : 0);
+    auto densityLow = static_cast<uint8_t>(dpi > 0 ? dpi & 0xff : 1);
+
+    // SOI + APP0 JFIF
+    const uint8_t jfif[] = {0xff, 0xd8, 0xff, 0xe0, 0, 16, 'J', 'F', 'I', 'F', 0, 1, 1, density,
+                            densityHigh, densityLow, densityHigh, densityLow, 0, 0};
+    out.insert(out.end(), jfif, jfif + sizeof(jfif));
+
+    PutMarker(out, 0xdb, 2 + 65 * (layout.color ? 2 : 1));
+    PutQuant(out, 0, luma);
+    if (layout.color) {
+        PutQuant(out, 1, chroma);
+    }
+
+    // SOF0
+    PutMarker(out, 0xc0, 8 + 3 * components);
+    out.push_back(8);
+    out.push_back(static_cast<uint8_t>(planes.height >> 8));
+    out.push_back(static_cast<uint8_t>(planes.height & 0xff));
+    out.push_back(static_cast<uint8_t>(planes.width >> 8));
+    out.push_back(static_cast<uint8_t>(planes.width & 0xff));
+    out.push_back(static_cast<uint8_t>(components));
+    out.push_back(1);
+    out.push_back(layout.color ? 0x22 : 0x11);
+    out.push_back(0);
+    if (layout.color) {
+        out.insert(out.end(), {2, 0x11, 1, 3, 0x11, 1});
+    }
+
+    // DHT
+    PutMarker(out, 0xc4, 2 + (1 + 16 + 12) + (1 + 16 + 162)
+                             + (layout.color ? (1 + 16 + 12) + (1 + 16 + 162) : 0));
+    PutHuffman(out, 0x00, LumaDcBits, DcValues);
+    PutHuffman(out, 0x10, LumaAcBits, LumaAcValues);
+    if (layout.color) {
+        PutHuffman(out, 0x01, ChromaDcBits, DcValues);
+        PutHuffman(out, 0x11, ChromaAcBits, ChromaAcValues);
+    }
+
+    // DRI: a restart interval of one MCU row
+    PutMarker(out, 0xdd, 4);
+    out.push_back(static_cast<uint8_t>(layout.mcusX >> 8));
+    out.push_back(static_cast<uint8_t>(layout.mcusX & 0xff));
+
+    // SOS
+    PutMarker(out, 0xda, 6 + 2 * components);
+    out.push_back(static_cast<uint8_t>(components));
+    out.push_back(1);
+    out.push_back(0x00);
+    if (layout.color) {
+        out.insert(out.end(), {2, 0x11, 3, 0x11});
+    }
+    out.insert(out.end(), {0, 63, 0});
+}
+
+} // namespace
+
+std::vector<uint8_t> Encode(const Planes &planes, int quality, ThreadPool *pool, int dpi)
+{
+    std::vector<uint8_t> out;
+
+    if (!planes.y || planes.width <= 0 || planes.height <= 0
+        || planes.width > 65535 || planes.height > 65535) {
+        return out;
+    }
+
+    Layout layout;
+    layout.color = planes.u && planes.v;
+    layout.mcuSize = layout.color ? 16 : 8;
+    layout.mcusX = (planes.width + layout.mcuSize - 1) / layout.mcuSize;
+    layout.mcusY = (planes.height + layout.mcuSize - 1) / layout.mcuSize;
+
+    Quantizer luma(LumaQuant, quality);
+    Quantizer chroma(ChromaQuant, quality);
+
+    PutHeader(out, planes, layout, luma, chroma, dpi);
+
+    auto threads = pool ? static_cast<int>(pool->Size()) + 1 : 1;
+    auto rowsPerStrip = (layout.mcusY + threads - 1) / threads;
+    auto strips = static_cast<size_t>((layout.mcusY + rowsPerStrip - 1) / rowsPerStrip);
+
+    std::vector<std::vector<uint8_t>> parts(strips);
+
+    auto encodeStrip = [&](size_t index) {
+        auto rowBegin = static_cast<int>(index) * rowsPerStrip;
+        auto rowEnd = std::min(layout.mcusY, rowBegin + rowsPerStrip);
+        // About one byte per pixel is enough for the most detailed scenes
+        parts[index].reserve(static_cast<size_t>(rowEnd - rowBegin) * layout.mcuSize * planes.width / 2);
+        EncodeRows(planes, layout, luma, chroma, rowBegin, rowEnd, parts[index]);
+    };
+
+    if (pool && strips > 1) {
+        pool->ParallelFor(strips, encodeStrip);
+    } else {
+        encodeStrip(0);
+    }
+
+    for (const auto &part : parts) {
+        out.insert(out.end(), part.begin(), part.end());
+    }
+
+    out.push_back(0xff);
+    out.push_back(0xd9); // EOI
+
+    return out;
+}
+
+} // namespace jpeg
@@ -0,0 +1,203 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/components.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace omr {
+
+namespace {
+
+// Non-zero pixels [start, end) of row y
+struct Run
+{
+    int y;
+    int start;
+    int end;
+    int32_t label;
+};
+
+// Disjoint sets of provisional labels, the root of a set is its
+// smallest label: the one of the run met first
+class Labels
+{
+public:
+    int32_t Add()
+    {
+        auto label = static_cast<int32_t>(m_parent.size());
+        m_parent.push_back(label);
+        return label;
+    }
+
+    int32_t Find(int32_t label)
+    {
+        auto root = label;
+        while (m_parent[root] != root) {
+            root = m_parent[root];
+        }
+        while (m_parent[label] != root) {
+            auto next = m_parent[label];
+            m_parent[label] = root;
+            label = next;
+        }
+        return root;
+    }
+
+    void Join(int32_t a, int32_t b)
+    {
+        a = Find(a);
+        b = Find(b);
+        if (a < b) {
+            m_parent[b] = a;
+        } else if (b < a) {
+            m_parent[a] = b;
+        }
+    }
+
+    size_t Size() const
+    {
+        return m_parent.size();
+    }
+
+private:
+    std::vector<int32_t> m_parent;
+};
+
+} // namespace
+
+Components FindComponents(const Image &binary, std::vector<int32_t> *labels)
+{
+    Components components;
+
+    auto width = binary.width;
+    auto height = binary.height;
+
+    std::vector<Run> runs;
+    Labels sets;
+
+    // Runs of the row above are [above, current) of `runs`
+    size_t above = 0;
+
+    for (int y = 0; y < height; y++) {
+        auto row = binary.Row(y);
+        auto current = runs.size();
+        auto candidate = above;
+
+        int x = 0;
+        while (x < width) {
+            // Background is skipped 8 bytes at a time
+            while (x + 8 <= width) {
+                uint64_t word;
+                std::memcpy(&word, row + x, sizeof(word));
+                if (word != 0) {
+                    break;
+                }
+                x += 8;
+            }
+            while (x < width && row[x] == 0) {
+                x++;
+            }
+            if (x == width) {
+                break;
+            }
+
+            auto start = x;
+            while (x < width && row[x] != 0) {
+                x++;
+            }
+
+            // 8-connected: runs above touching [start - 1, x]
+            while (candidate < current && runs[candidate].end < start) {
+                candidate++;
+            }
+
+            int32_t label = -1;
+            for (auto index = candidate; index < current && runs[index].start <= x; index++) {
+                if (label < 0) {
+                    label = runs[index].label;
+                } else {
+                    sets.Join(label, runs[index].label);
+                }
+            }
+            if (label < 0) {
+                label = sets.Add();
+            }
+
+            runs.push_back(Run{y, start, x, label});
+        }
+
+        above = current;
+    }
+
+    // Final indexes in the order of the sets' first runs
+    std::vector<int32_t> index(sets.Size(), -1);
+    int32_t count = 0;
+    for (size_t label = 0; label < sets.Size(); label++) {
+        auto root = sets.Find(static_cast<int32_t>(label));
+        if (index[root] < 0) {
+            index[root] = count++;
+        }
+        index[label] = index[root];
+    }
+
+    std::vector<int> right(count, -1);
+    std::vector<int> bottom(count, -1);
+    std::vector<double> sumX(count, 0);
+    std::vector<double> sumY(count, 0);
+
+    components.left.assign(count, width);
+    components.top.assign(count, height);
+    components.area.assign(count, 0);
+
+    for (auto &run : runs) {
+        auto id = index[run.label];
+        auto length = run.end - run.start;
+
+        run.label = id + 1;
+        components.left[id] = std::min(components.left[id], run.start);
+        components.top[id] = std::min(components.top[id], run.y);
+        right[id] = std::max(right[id], run.end - 1);
+        bottom[id] = std::max(bottom[id], run.y);
+        components.area[id] += length;
+        sumX[id] += length * (run.start + run.end - 1) * 0.5;
+        sumY[id] += static_cast<double>(length) * run.y;
+    }
+
+    components.width.resize(count);
+    components.height.resize(count);
+    components.centerX.resize(count);
+    components.centerY.resize(count);
+
+    for (int32_t id = 0; id < count; id++) {
+        components.width[id] = right[id] - components.left[id] + 1;
+        components.height[id] = bottom[id] - components.top[id] + 1;
+        components.centerX[id] = static_cast<float>(sumX[id] / components.area[id]);
+        components.centerY[id] = static_cast<float>(sumY[id] / components.area[id]);
+    }
+
+    if (labels) {
+        labels->assign(static_cast<size_t>(width) * height, 0);
+        for (const auto &run : runs) {
+            auto row = labels->data() + static_cast<size_t>(run.y) * width;
+            std::fill(row + run.start, row + run.end, run.label);
+        }
+    }
+
+    return components;
+}
+
+std::vector<int> Select(const std::vector<uint8_t> &mask)
+{
+    std::vector<int> indexes;
+    for (size_t index = 0; index < mask.size(); index++) {
+        if (mask[index] != 0) {
+            indexes.push_back(static_cast<int>(index));
+        }
+    }
+    return indexes;
+}
+
+} // namespace omr
@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/corners.h>
+#include <camera_aurora/omr/components.h>
+#include <camera_aurora/omr/filters.h>
+#include <camera_aurora/omr/skew.h>
+
+#include <libyuv/libyuv.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace omr {
+
+namespace {
+
+// Smallest table, share of the searched image
+constexpr double MinTableArea = 0.05;
+
+// Closing size of find_table_corners
+constexpr int CloseSize = 5;
+
+typedef std::chrono::steady_clock Clock;
+
+int64_t Micros(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+} // namespace
+
+bool FindCorners(const Plane &plane, Quad &corners, int searchSize, CornerTimes *times)
+{
+    if (plane.width <= 0 || plane.height <= 0) {
+        return false;
+    }
+
+    auto start = Clock::now();
+
+    // Box-downscaled, the outline does not need the full resolution
+    auto scale = std::min(1.0, static_cast<double>(searchSize) / std::max(plane.width, plane.height));
+    Image small(std::max(1, static_cast<int>(plane.width * scale)),
+                std::max(1, static_cast<int>(plane.height * scale)));
+
+    libyuv::ScalePlane(plane.data, plane.stride, plane.width, plane.height,
+                       small.data.data(), small.width, small.width, small.height,
+                       libyuv::kFilterBox);
+
+    auto blurred = GaussianBlur(small.View());
+    auto binary = Close(ThresholdOtsu(blurred.View(), true), CloseSize);
+
+    auto binarized = Clock::now();
+    if (times) {
+        times->binarize = Micros(start, binarized);
+    }
+
+    std::vector<int32_t> labels;
+    auto components = FindComponents(binary, &labels);
+
+    // The outline enclosing the largest area, its box stands for it
+    size_t largest = 0;
+    for (size_t index = 1; index < components.Size(); index++) {
+        if (components.Box(index).Area() > components.Box(largest).Area()) {
+            largest = index;
+        }
+    }
+
+    if (components.Size() == 0
+        || components.Box(largest).Area() < MinTableArea * small.width * small.height) {
+        if (times) {
+            times->detect = Micros(binarized, Clock::now());
+        }
+        return false;
+    }
+
+    auto id = static_cast<int32_t>(largest) + 1;
+    auto box = components.Box(largest);
+
+    // The outline alone, its skew is the table's
+    Image outline(box.width, box.height);
+    for (int y = 0; y < box.height; y++) {
+        auto row = labels.data() + static_cast<size_t>(box.y + y) * small.width + box.x;
+        auto out = outline.Row(y);
+        for (int x = 0; x < box.width; x++) {
+            out[x] = row[x] == id ? 255 : 0;
+        }
+    }
+
+    // The diagonals are taken in the deskewed frame: on a rotated sheet
+    // the image diagonals run close to its edges and pick the wrong
+    // points. The quad itself stays in the image, the one warp of the
+    // sheet takes out the skew along with the perspective.
+    auto skew = EstimateSkew(outline);
+    auto cos = std::cos(skew);
+    auto sin = std::sin(skew);
+
+    auto minSum = std::numeric_limits<float>::max(), maxSum = std::numeric_limits<float>::lowest();
+    auto minDiff = std::numeric_limits<float>::max(), maxDiff = std::numeric_limits<float>::lowest();
+    Point topLeft, topRight, bottomRight, bottomLeft;
+
+    for (int y = box.y; y < box.y + box.height; y++) {
+        auto row = labels.data() + static_cast<size_t>(y) * small.width;
+        for (int x = box.x; x < box.x + box.width; x++) {
+            if (row[x] != id) {
+                continue;
+            }
+            // Pixel centers
+            Point point{x + 0.5f, y + 0.5f};
+            auto u = point.x * cos + point.y * sin;
+            auto v = point.y * cos - point.x * sin;
+            if (u + v < minSum) {
+                minSum = u + v;
+                topLeft = point;
+            }
+            if (u + v > maxSum) {
+                maxSum = u + v;
+                bottomRight = point;
+            }
+            if (u - v > maxDiff) {
+                maxDiff = u - v;
+                topRight = point;
+            }
+            if (u - v < minDiff) {
+                minDiff = u - v;
+                bottomLeft = point;
+            }
+        }
+    }
+
+    auto scaleX = static_cast<float>(plane.width) / small.width;
+    auto scaleY = static_cast<float>(plane.height) / small.height;
+
+    corners = {topLeft, topRight, bottomRight, bottomLeft};
+    for (auto &corner : corners) {
+        corner.x *= scaleX;
+        corner.y *= scaleY;
+    }
+
+    if (times) {
+        times->detect = Micros(binarized, Clock::now());
+    }
+    return true;
+}
+
+} // namespace omr
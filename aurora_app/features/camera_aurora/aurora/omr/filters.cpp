@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/filters.h>
+#include <camera_aurora/binarize.h>
+
+#include <algorithm>
+
+namespace omr {
+
+namespace {
+
+// Running extreme of the `size` pixels around each one, along rows
+// (step 1) or columns (step width); `pick` is std::min or std::max
+template <typename Pick>
+void Extreme(const uint8_t *src, uint8_t *dst, int width, int height, int size, bool rows, Pick pick)
+{
+    auto radius = size / 2;
+    auto length = rows ? width : height;
+    auto lines = rows ? height : width;
+    auto step = rows ? 1 : width;
+    auto next = rows ? width : 1;
+
+    for (int line = 0; line < lines; line++) {
+        auto in = src + static_cast<size_t>(line) * next;
+        auto out = dst + static_cast<size_t>(line) * next;
+
+        for (int i = 0; i < length; i++) {
+            auto from = std::max(0, i - radius);
+            auto to = std::min(length - 1, i + radius);
+            auto value = in[static_cast<size_t>(from) * step];
+            for (int j = from + 1; j <= to; j++) {
+                value = pick(value, in[static_cast<size_t>(j) * step]);
+            }
+            out[static_cast<size_t>(i) * step] = value;
+        }
+    }
+}
+
+uint8_t Min(uint8_t a, uint8_t b)
+{
+    return std::min(a, b);
+}
+
+uint8_t Max(uint8_t a, uint8_t b)
+{
+    return std::max(a, b);
+}
+
+} // namespace
+
+Image GaussianBlur(const Plane &src)
+{
+    Image result(src.width, src.height);
+    if (result.IsEmpty()) {
+        return result;
+    }
+
+    std::vector<uint16_t> rows(static_cast<size_t>(src.width) * src.height);
+    auto last = src.width - 1;
+
+    for (int y = 0; y < src.height; y++) {
+        auto in = src.Row(y);
+        auto out = rows.data() + static_cast<size_t>(y) * src.width;
+        for (int x = 0; x < src.width; x++) {
+            out[x] = in[std::max(x - 2, 0)] + 4 * in[std::max(x - 1, 0)] + 6 * in[x]
+                     + 4 * in[std::min(x + 1, last)] + in[std::min(x + 2, last)];
+        }
+    }
+
+    auto bottom = src.height - 1;
+    auto row = [&rows, &src](int y) {
+        return rows.data() + static_cast<size_t>(y) * src.width;
+    };
+
+    for (int y = 0; y < src.height; y++) {
+        auto r0 = row(std::max(y - 2, 0));
+        auto r1 = row(std::max(y - 1, 0));
+        auto r2 = row(y);
+        auto r3 = row(std::min(y + 1, bottom));
+        auto r4 = row(std::min(y + 2, bottom));
+        auto out = result.Row(y);
+        for (int x = 0; x < src.width; x++) {
+            auto sum = r0[x] + 4 * r1[x] + 6 * r2[x] + 4 * r3[x] + r4[x];
+            out[x] = static_cast<uint8_t>((sum + 128) >> 8);
+        }
+    }
+
+    return result;
+}
+
+Image Threshold(const Plane &src, int threshold, bool invert)
+{
+    Image result(src.width, src.height);
+    uint8_t above = invert ? 0 : 255;
+    uint8_t below = invert ? 255 : 0;
+
+    for (int y = 0; y < src.height; y++) {
+        auto in = src.Row(y);
+        auto out = result.Row(y);
+        for (int x = 0; x < src.width; x++) {
+            out[x] = in[x] > threshold ? above : below;
+        }
+    }
+
+    return result;
+}
+
+Image ThresholdOtsu(const Plane &src, bool invert)
+{
+    auto histogram = binarize::MakeHistogram(src.data, src.stride, src.width, src.height);
+    return Threshold(src, binarize::Otsu(histogram), invert);
+}
+
+Image Close(const Image &src, int size)
+{
+    Image result(src.width, src.height);
+    if (result.IsEmpty()) {
+        return result;
+    }
+
+    Image temp(src.width, src.height);
+    auto width = src.width;
+    auto height = src.height;
+
+    // The square is separable: rows, then columns
+    Extreme(src.data.data(), temp.data.data(), width, height, size, true, Max);
+    Extreme(temp.data.data(), result.data.data(), width, height, size, false, Max);
+    Extreme(result.data.data(), temp.data.data(), width, height, size, true, Min);
+    Extreme(temp.data.data(), result.data.data(), width, height, size, false, Min);
+
+    return result;
+}
+
+} // namespace omr
@@ -0,0 +1,213 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/grader.h>
+#include <camera_aurora/omr/corners.h>
+#include <camera_aurora/omr/grid.h>
+#include <camera_aurora/omr/warp.h>
+#include <camera_aurora/binarize.h>
+#include <camera_aurora/trace.h>
+
+#include <chrono>
+
+namespace omr {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Ends a stage, its time goes to the result
+class Lap
+{
+public:
+    explicit Lap(Result &result)
+        : m_result(result)
+        , m_start(Clock::now())
+    {}
+
+    // The stage ran inside the last one, its time is taken out of it
+    void Split(Result::Stage inner, int64_t micros, Result::Stage outer)
+    {
+        m_result.micros[static_cast<size_t>(inner)] = micros;
+        m_result.micros[static_cast<size_t>(outer)] -= micros;
+    }
+
+    void End(Result::Stage stage)
+    {
+        auto now = Clock::now();
+        m_result.micros[static_cast<size_t>(stage)] =
+            std::chrono::duration_cast<std::chrono::microseconds>(now - m_start).count();
+        m_start = now;
+    }
+
+private:
+    Result &m_result;
+    Clock::time_point m_start;
+};
+
+// Each fiducial darker on average than Otsu's threshold of the table
+bool HasFiducials(const Image &table, const CompiledLayout &layout)
+{
+    if (layout.Fiducials().empty()) {
+        return true;
+    }
+
+    auto threshold = binarize::Otsu(binarize::MakeHistogram(table.data.data(), table.width,
+                                                            table.width, table.height));
+
+    for (const auto &fiducial : layout.Fiducials()) {
+        int64_t sum = 0;
+        for (int y = fiducial.y; y < fiducial.y + fiducial.height; y++) {
+            auto row = table.Row(y);
+            for (int x = fiducial.x; x < fiducial.x + fiducial.width; x++) {
+                sum += row[x];
+            }
+        }
+        if (fiducial.Area() == 0 || sum > static_cast<int64_t>(threshold) * fiducial.Area()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// As find_answer: a question missing from the key counts as incorrect
+void Compare(const std::vector<Mark> &marks, const AnswerKey &key, Result &result)
+{
+    for (const auto &mark : marks) {
+        auto question = std::to_string(mark.question + 1);
+        auto letter = std::string(1, static_cast<char>('A' + mark.column));
+        auto correct = key.find(question);
+
+        if (correct == key.end()) {
+            result.answers.push_back(Answer{question, "", "", mark.confidence});
+            result.incorrect++;
+            continue;
+        }
+
+        result.answers.push_back(Answer{question, letter, correct->second, mark.confidence});
+        if (letter == correct->second) {
+            result.correct++;
+        } else {
+            result.incorrect++;
+        }
+    }
+}
+
+} // namespace
+
+const char *Result::StageName(Stage stage)
+{
+    switch (stage) {
+    case Stage::Binarize:
+        return "binarize";
+    case Stage::Corners:
+        return "corners";
+    case Stage::Warp:
+        return "warp";
+    case Stage::Grid:
+        return "grid";
+    case Stage::Marks:
+        return "marks";
+    case Stage::Compare:
+        return "compare";
+    }
+    return "";
+}
+
+Result Grade(const Plane &plane, const AnswerKey &key, ThreadPool *pool)
+{
+    trace::Scope span("omr.grade");
+
+    Result result;
+    Lap lap(result);
+
+    Quad corners;
+    CornerTimes times;
+    if (!FindCorners(plane, corners, CornerSearchSize, &times)) {
+        result.error = "Answer table not found";
+        return result;
+    }
+    lap.End(Result::Stage::Corners);
+    lap.Split(Result::Stage::Binarize, times.binarize, Result::Stage::Corners);
+
+    int width = 0;
+    int height = 0;
+    StraightSize(corners, width, height);
+    auto table = Warp(plane, corners, width, height, pool);
+    lap.End(Result::Stage::Warp);
+
+    if (table.IsEmpty()) {
+        result.error = "Answer table not found";
+        return result;
+    }
+
+    auto grid = FindGrid(table);
+    lap.End(Result::Stage::Grid);
+
+    if (grid.columns.empty() || grid.questions.empty()) {
+        result.error = "Answer grid not found";
+        return result;
+    }
+
+    auto marks = MatchMarks(grid, FindMarked(table, grid.cells));
+    lap.End(Result::Stage::Marks);
+
+    Compare(marks, key, result);
+    lap.End(Result::Stage::Compare);
+
+    return result;
+}
+
+Result Grade(const Plane &plane, const CompiledLayout &layout, const AnswerKey &key, ThreadPool *pool)
+{
+    trace::Scope span("omr.grade");
+
+    Result result;
+    Lap lap(result);
+
+    Quad corners;
+    CornerTimes times;
+    if (!FindCorners(plane, corners, CornerSearchSize, &times)) {
+        result.error = "Answer table not found";
+        return result;
+    }
+    lap.End(Result::Stage::Corners);
+    lap.Split(Result::Stage::Binarize, times.binarize, Result::Stage::Corners);
+
+    const auto &source = layout.Source();
+    auto table = Warp(plane, corners, source.width, source.height, pool);
+    lap.End(Result::Stage::Warp);
+
+    if (table.IsEmpty()) {
+        result.error = "Answer table not found";
+        return result;
+    }
+
+    // The grid is known, the fiducials tell that it is this sheet
+    if (!HasFiducials(table, layout)) {
+        result.error = "Sheet does not match the layout";
+        return result;
+    }
+    lap.End(Result::Stage::Grid);
+
+    // Cells in the order of questions and options, one pass
+    auto fills = MeasureFill(table, layout.Cells());
+    std::vector<Mark> marks;
+    for (size_t index = 0; index < fills.size(); index++) {
+        if (fills[index].marked) {
+            auto options = static_cast<size_t>(source.options);
+            marks.push_back(Mark{static_cast<int>(index / options), static_cast<int>(index % options),
+                                 fills[index].confidence});
+        }
+    }
+    lap.End(Result::Stage::Marks);
+
+    Compare(marks, key, result);
+    lap.End(Result::Stage::Compare);
+
+    return result;
+}
+
+} // namespace omr
@@ -0,0 +1,296 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/grid.h>
+#include <camera_aurora/omr/components.h>
+#include <camera_aurora/omr/filters.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace omr {
+
+namespace {
+
+// aurora_cv works in pixels of the photo: cells starting within 5 px
+// of an edge are header cells, the corner cell starts within 10 px,
+// question cells are over 120 px and at least 5 px apart. Here the
+// distances grow with the table, from these minimums, and the letter
+// cells are filtered by area too: specks along the edge are not letters.
+constexpr int EdgeMin = 5;
+constexpr int EdgeShare = 100;
+constexpr int CellAreaMin = 120;
+constexpr int CellAreaShare = 10000;
+
+// detect_empty_contours: contrast 0.8x + 5, sharpening with 11 in the
+// middle of -1s, a cell darker than this on average is marked
+constexpr float ContrastAlpha = 0.8f;
+constexpr float ContrastBeta = 5;
+constexpr int SharpenCenter = 11;
+constexpr int MarkedBelow = 240;
+
+uint8_t Saturate(int value)
+{
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+// OpenCV's default border, the edge pixel is not repeated
+int Reflect(int i, int size)
+{
+    if (size == 1) {
+        return 0;
+    }
+    while (i < 0 || i >= size) {
+        i = i < 0 ? -i : 2 * size - i - 2;
+    }
+    return i;
+}
+
+} // namespace
+
+Grid FindGrid(const Image &table)
+{
+    Grid grid;
+
+    auto blurred = GaussianBlur(table.View());
+    auto binary = ThresholdOtsu(blurred.View(), false);
+    auto components = FindComponents(binary);
+
+    auto edgeX = std::max(EdgeMin, table.width / EdgeShare);
+    auto edgeY = std::max(EdgeMin, table.height / EdgeShare);
+    auto cellArea = std::max(CellAreaMin, table.width * table.height / CellAreaShare);
+
+    // Masks of the three kinds over the component arrays, filled
+    // without branches
+    auto count = components.Size();
+    std::vector<uint8_t> cells(count);
+    std::vector<uint8_t> columns(count);
+    std::vector<uint8_t> rows(count);
+
+    for (size_t index = 0; index < count; index++) {
+        auto x = components.left[index];
+        auto y = components.top[index];
+        auto large = components.area[index] > cellArea;
+        cells[index] = (x > edgeX) & (y > edgeY);
+        columns[index] = (y < edgeY) & (x >= 2 * edgeX) & large;
+        rows[index] = (x < edgeX) & (y >= 2 * edgeY) & large;
+    }
+
+    for (auto index : Select(cells)) {
+        grid.cells.push_back(components.Box(index));
+    }
+    for (auto index : Select(columns)) {
+        grid.columns.push_back(components.Box(index));
+    }
+
+    std::sort(grid.columns.begin(), grid.columns.end(), [](const Rect &a, const Rect &b) {
+        return a.x < b.x;
+    });
+
+    auto questions = Select(rows);
+    std::sort(questions.begin(), questions.end(), [&components](int a, int b) {
+        return components.top[a] < components.top[b];
+    });
+
+    // Pieces of one cell split by a stroke are one question
+    for (auto index : questions) {
+        auto y = components.top[index];
+        auto close = std::any_of(grid.questions.begin(), grid.questions.end(),
+                                 [y, edgeY](const Rect &kept) {
+                                     return std::abs(y - kept.y) < edgeY;
+                                 });
+        if (!close) {
+            grid.questions.push_back(components.Box(index));
+        }
+    }
+
+    // Letters A to Z
+    if (grid.columns.size() > 26) {
+        grid.columns.resize(26);
+    }
+
+    return grid;
+}
+
+std::vector<Fill> MeasureFill(const Image &table, const std::vector<Rect> &cells)
+{
+    std::vector<Fill> fills(cells.size());
+    for (size_t index = 0; index < cells.size(); index++) {
+        fills[index].cell = cells[index];
+    }
+
+    if (table.IsEmpty() || cells.empty()) {
+        return fills;
+    }
+
+    uint8_t contrast[256];
+    for (int value = 0; value < 256; value++) {
+        contrast[value] = Saturate(static_cast<int>(ContrastAlpha * value + ContrastBeta + 0.5f));
+    }
+
+    // Only the area under the cells: the header row and the question
+    // column are left out
+    auto left = table.width;
+    auto top = table.height;
+    auto right = 0;
+    auto bottom = 0;
+    for (const auto &cell : cells) {
+        left = std::min(left, std::max(0, cell.x));
+        top = std::min(top, std::max(0, cell.y));
+        right = std::max(right, std::min(table.width, cell.x + cell.width));
+        bottom = std::max(bottom, std::min(table.height, cell.y + cell.height));
+    }
+    if (right <= left || bottom <= top) {
+        return fills;
+    }
+
+    auto width = right - left;
+    auto height = bottom - top;
+
+    // Summed-area table of the sharpened pixels with a zero first row
+    // and column. Sums of 32 bits may wrap on huge tables, the box
+    // differences of one cell do not.
+    auto stride = static_cast<size_t>(width) + 1;
+    std::vector<uint32_t> integral(stride * (height + 1), 0);
+
+    // Rows after the contrast, for the table row above, at and below
+    // the current one
+    Image enhanced(table.width, 3);
+    auto enhance = [&table, &enhanced, &contrast](int y, int slot) {
+        auto src = table.Row(Reflect(y, table.height));
+        auto dst = enhanced.Row(slot);
+        for (int x = 0; x < table.width; x++) {
+            dst[x] = contrast[src[x]];
+        }
+    };
+    enhance(top - 1, 0);
+    enhance(top, 1);
+
+    // The kernel is 12 times the center less the 3x3 box: column sums
+    // of three rows, then three of those. columns[x + 1] is column
+    // left + x, the ends hold the columns next to the area or the
+    // reflected ones at the table edge.
+    std::vector<int> columns(static_cast<size_t>(width) + 2);
+    std::vector<uint8_t> sharpened(static_cast<size_t>(width));
+
+    for (int y = 0; y < height; y++) {
+        enhance(top + y + 1, (y + 2) % 3);
+
+        auto above = enhanced.Row(y % 3);
+        auto row = enhanced.Row((y + 1) % 3);
+        auto below = enhanced.Row((y + 2) % 3);
+
+        for (int x = 0; x < width; x++) {
+            columns[x + 1] = above[left + x] + row[left + x] + below[left + x];
+        }
+        for (auto x : {-1, width}) {
+            auto column = Reflect(left + x, table.width);
+            columns[x + 1] = above[column] + row[column] + below[column];
+        }
+
+        for (int x = 0; x < width; x++) {
+            auto box = columns[x] + columns[x + 1] + columns[x + 2];
+            sharpened[x] = Saturate((SharpenCenter + 1) * row[left + x] - box);
+        }
+
+        auto previous = integral.data() + y * stride + 1;
+        auto current = previous + stride;
+        uint32_t sum = 0;
+
+        for (int x = 0; x < width; x++) {
+            sum += sharpened[x];
+            current[x] = previous[x] + sum;
+        }
+    }
+
+    // Marks are compared with the typical mark of the sheet, blank
+    // cells with the paper, 255 after the contrast
+    std::vector<float> means;
+    for (auto &fill : fills) {
+        // Cells come from the table's components, clipped all the same
+        auto x0 = std::max(0, fill.cell.x - left);
+        auto y0 = std::max(0, fill.cell.y - top);
+        auto x1 = std::min(width, fill.cell.x + fill.cell.width - left);
+        auto y1 = std::min(height, fill.cell.y + fill.cell.height - top);
+        if (x1 <= x0 || y1 <= y0) {
+            continue;
+        }
+
+        auto upper = integral.data() + y0 * stride;
+        auto lower = integral.data() + y1 * stride;
+        auto sum = lower[x1] - lower[x0] - upper[x1] + upper[x0];
+        auto mean = static_cast<float>(sum) / ((x1 - x0) * (y1 - y0));
+
+        fill.ratio = 1 - mean / 255;
+        fill.marked = mean < MarkedBelow;
+        if (fill.marked) {
+            means.push_back(mean);
+        }
+    }
+
+    auto typical = static_cast<float>(MarkedBelow);
+    if (!means.empty()) {
+        std::nth_element(means.begin(), means.begin() + means.size() / 2, means.end());
+        typical = means[means.size() / 2];
+    }
+
+    for (auto &fill : fills) {
+        auto mean = 255 * (1 - fill.ratio);
+        auto distance = fill.marked ? MarkedBelow - mean : mean - MarkedBelow;
+        auto scale = fill.marked ? MarkedBelow - typical : 255 - MarkedBelow;
+        fill.confidence = scale > 0 ? std::min(1.0f, distance / scale) : 1.0f;
+    }
+
+    return fills;
+}
+
+std::vector<Fill> FindMarked(const Image &table, const std::vector<Rect> &cells)
+{
+    auto fills = MeasureFill(table, cells);
+    fills.erase(std::remove_if(fills.begin(), fills.end(), [](const Fill &fill) {
+        return !fill.marked;
+    }), fills.end());
+    return fills;
+}
+
+std::vector<Mark> MatchMarks(const Grid &grid, const std::vector<Fill> &marked)
+{
+    std::vector<Mark> marks;
+
+    for (const auto &fill : marked) {
+        auto cx = fill.cell.x + fill.cell.width / 2;
+        auto cy = fill.cell.y + fill.cell.height / 2;
+
+        for (size_t row = 0; row < grid.questions.size(); row++) {
+            const auto &question = grid.questions[row];
+            if (cy < question.y || cy > question.y + question.height) {
+                continue;
+            }
+            for (size_t column = 0; column < grid.columns.size(); column++) {
+                const auto &letter = grid.columns[column];
+                if (cx >= letter.x && cx <= letter.x + letter.width) {
+                    marks.push_back(Mark{static_cast<int>(row), static_cast<int>(column), fill.confidence});
+                }
+            }
+        }
+    }
+
+    // Pieces of one cell: the surest of them stays
+    std::sort(marks.begin(), marks.end(), [](const Mark &a, const Mark &b) {
+        if (a.question != b.question) {
+            return a.question < b.question;
+        }
+        if (a.column != b.column) {
+            return a.column < b.column;
+        }
+        return a.confidence > b.confidence;
+    });
+    marks.erase(std::unique(marks.begin(), marks.end(), [](const Mark &a, const Mark &b) {
+        return a.question == b.question && a.column == b.column;
+    }), marks.end());
+
+    return marks;
+}
+
+} // namespace omr
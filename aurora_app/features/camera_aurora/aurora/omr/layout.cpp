@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/layout.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace omr {
+
+namespace {
+
+// Straightened tables beyond this are a mistake, not a sheet
+constexpr int MaxSide = 8192;
+
+bool IsShare(float value)
+{
+    return value >= 0 && value < 1;
+}
+
+// Pixels [share * size] to [(share + length) * size]
+Rect Span(float x, float y, float width, float height, const Layout &layout)
+{
+    auto left = static_cast<int>(std::lround(x * layout.width));
+    auto top = static_cast<int>(std::lround(y * layout.height));
+    auto right = static_cast<int>(std::lround((x + width) * layout.width));
+    auto bottom = static_cast<int>(std::lround((y + height) * layout.height));
+
+    left = std::max(0, std::min(layout.width, left));
+    top = std::max(0, std::min(layout.height, top));
+    right = std::max(left, std::min(layout.width, right));
+    bottom = std::max(top, std::min(layout.height, bottom));
+
+    return Rect{left, top, right - left, bottom - top};
+}
+
+} // namespace
+
+std::string Check(const Layout &layout)
+{
+    if (layout.id.empty()) {
+        return "Layout ID is empty";
+    }
+    if (layout.questions <= 0 || layout.options <= 0 || layout.options > 26) {
+        return "Layout needs questions and 1 to 26 options";
+    }
+    if (layout.width <= 0 || layout.height <= 0 || layout.width > MaxSide || layout.height > MaxSide) {
+        return "Layout size is out of range";
+    }
+    if (!IsShare(layout.header) || !IsShare(layout.labels) || layout.inset < 0 || layout.inset >= 0.5f) {
+        return "Layout shares are out of range";
+    }
+
+    // Every cell keeps at least a pixel after the inset
+    auto cellWidth = (1 - layout.labels) * layout.width / layout.options;
+    auto cellHeight = (1 - layout.header) * layout.height / layout.questions;
+    if ((1 - 2 * layout.inset) * std::min(cellWidth, cellHeight) < 1) {
+        return "Layout cells are smaller than a pixel";
+    }
+
+    for (const auto &fiducial : layout.fiducials) {
+        if (!IsShare(fiducial.x) || !IsShare(fiducial.y)) {
+            return "Layout fiducial is outside of the table";
+        }
+    }
+    if (!layout.fiducials.empty() && (layout.fiducialSize <= 0 || layout.fiducialSize >= 1)) {
+        return "Layout fiducial size is out of range";
+    }
+
+    return "";
+}
+
+CompiledLayout::CompiledLayout(const Layout &layout)
+    : m_layout(layout)
+{
+    auto cellWidth = (1 - layout.labels) / layout.options;
+    auto cellHeight = (1 - layout.header) / layout.questions;
+    auto insetX = cellWidth * layout.inset;
+    auto insetY = cellHeight * layout.inset;
+
+    m_cells.reserve(static_cast<size_t>(layout.questions) * layout.options);
+
+    for (int question = 0; question < layout.questions; question++) {
+        for (int option = 0; option < layout.options; option++) {
+            m_cells.push_back(Span(layout.labels + option * cellWidth + insetX,
+                                   layout.header + question * cellHeight + insetY,
+                                   cellWidth - 2 * insetX,
+                                   cellHeight - 2 * insetY,
+                                   layout));
+        }
+    }
+
+    // Square in pixels, the table may not be
+    auto side = layout.fiducialSize;
+    auto sideY = side * layout.width / layout.height;
+    for (const auto &fiducial : layout.fiducials) {
+        m_fiducials.push_back(Span(fiducial.x - side / 2, fiducial.y - sideY / 2, side, sideY, layout));
+    }
+}
+
+std::string LayoutRegistry::Add(const Layout &layout)
+{
+    auto error = Check(layout);
+    if (!error.empty()) {
+        return error;
+    }
+
+    auto compiled = std::make_shared<const CompiledLayout>(layout);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layouts[layout.id] = compiled;
+
+    return "";
+}
+
+std::shared_ptr<const CompiledLayout> LayoutRegistry::Find(const std::string &id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto layout = m_layouts.find(id);
+    return layout != m_layouts.end() ? layout->second : nullptr;
+}
+
+} // namespace omr
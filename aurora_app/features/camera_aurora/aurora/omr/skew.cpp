@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/skew.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace omr {
+
+namespace {
+
+constexpr int Decimation = 4;
+constexpr float CoarseStep = 1;
+constexpr float FineStep = 0.1f;
+constexpr float Radians = 3.14159265f / 180;
+
+// Peakiness of the projections of the points rotated back by `degrees`:
+// the sum of squared bin counts of rows and of columns
+int64_t Score(const std::vector<Point> &points, float degrees, int bins, std::vector<int> &rows,
+              std::vector<int> &columns)
+{
+    auto angle = degrees * Radians;
+    auto cos = std::cos(angle);
+    auto sin = std::sin(angle);
+    // Half a bin more rounds by truncation, the shifted points are positive
+    auto offset = bins / 2 + 0.5f;
+
+    rows.assign(bins, 0);
+    columns.assign(bins, 0);
+
+    for (const auto &point : points) {
+        auto u = static_cast<int>(point.x * cos + point.y * sin + offset);
+        auto v = static_cast<int>(point.y * cos - point.x * sin + offset);
+        columns[u]++;
+        rows[v]++;
+    }
+
+    int64_t score = 0;
+    for (int bin = 0; bin < bins; bin++) {
+        score += static_cast<int64_t>(rows[bin]) * rows[bin];
+        score += static_cast<int64_t>(columns[bin]) * columns[bin];
+    }
+    return score;
+}
+
+} // namespace
+
+float EstimateSkew(const Image &binary)
+{
+    // Ink blocks around the center, the rotations keep it in place
+    auto width = binary.width / Decimation;
+    auto height = binary.height / Decimation;
+    auto centerX = width / 2.0f;
+    auto centerY = height / 2.0f;
+
+    std::vector<Point> points;
+    for (int by = 0; by < height; by++) {
+        for (int bx = 0; bx < width; bx++) {
+            auto ink = false;
+            for (int y = by * Decimation; y < (by + 1) * Decimation && !ink; y++) {
+                auto row = binary.Row(y) + bx * Decimation;
+                for (int x = 0; x < Decimation; x++) {
+                    ink |= row[x] != 0;
+                }
+            }
+            if (ink) {
+                points.push_back(Point{bx - centerX, by - centerY});
+            }
+        }
+    }
+
+    if (points.empty()) {
+        return 0;
+    }
+
+    auto bins = static_cast<int>(std::ceil(std::hypot(width, height))) + 2;
+    std::vector<int> rows;
+    std::vector<int> columns;
+
+    auto search = [&](float from, float to, float step) {
+        auto best = from;
+        int64_t bestScore = -1;
+        for (auto degrees = from; degrees <= to + step / 2; degrees += step) {
+            auto score = Score(points, degrees, bins, rows, columns);
+            if (score > bestScore) {
+                bestScore = score;
+                best = degrees;
+            }
+        }
+        return best;
+    };
+
+    auto coarse = search(-MaxSkew, MaxSkew, CoarseStep);
+    auto fine = search(coarse - CoarseStep, coarse + CoarseStep, FineStep);
+
+    return fine * Radians;
+}
+
+} // namespace omr
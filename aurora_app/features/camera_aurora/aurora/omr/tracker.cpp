@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/tracker.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace omr {
+
+QuadTracker::QuadTracker(size_t frames)
+    : m_frames(std::max<size_t>(frames, 1))
+{}
+
+void QuadTracker::Add(const Quad &corners)
+{
+    m_history.push_back(corners);
+    if (m_history.size() > m_frames) {
+        m_history.pop_front();
+    }
+}
+
+void QuadTracker::Reset()
+{
+    m_history.clear();
+}
+
+size_t QuadTracker::Frames() const
+{
+    return m_history.size();
+}
+
+bool QuadTracker::IsEmpty() const
+{
+    return m_history.empty();
+}
+
+float QuadTracker::Jitter() const
+{
+    if (m_history.size() < 2) {
+        return 0;
+    }
+
+    auto count = static_cast<float>(m_history.size());
+    float sum = 0;
+
+    for (size_t corner = 0; corner < 4; corner++) {
+        Point mean;
+        for (const auto &quad : m_history) {
+            mean.x += quad[corner].x;
+            mean.y += quad[corner].y;
+        }
+        mean.x /= count;
+        mean.y /= count;
+
+        float squares = 0;
+        for (const auto &quad : m_history) {
+            auto dx = quad[corner].x - mean.x;
+            auto dy = quad[corner].y - mean.y;
+            squares += dx * dx + dy * dy;
+        }
+        sum += std::sqrt(squares / count);
+    }
+
+    return sum / 4;
+}
+
+float QuadTracker::Stability() const
+{
+    // A table seen for a few frames only is not stable yet
+    auto seen = static_cast<float>(m_history.size()) / m_frames;
+    return seen * std::max(0.0f, 1 - Jitter() / JitterLimit);
+}
+
+} // namespace omr
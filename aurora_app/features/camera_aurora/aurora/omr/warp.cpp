@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/warp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace omr {
+
+namespace {
+
+// Rows of the table per task, 8-bit fixed point weights
+constexpr int WarpStrip = 32;
+constexpr int32_t WarpOne = 256;
+
+double Distance(const Point &a, const Point &b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+} // namespace
+
+Homography RectToQuad(const Quad &quad, int width, int height)
+{
+    // Unit square to quad (Heckbert), then scaled to the rectangle
+    double x0 = quad[0].x, y0 = quad[0].y;
+    double x1 = quad[1].x, y1 = quad[1].y;
+    double x2 = quad[2].x, y2 = quad[2].y;
+    double x3 = quad[3].x, y3 = quad[3].y;
+
+    Homography unit;
+    auto sx = x0 - x1 + x2 - x3;
+    auto sy = y0 - y1 + y2 - y3;
+    auto dx1 = x1 - x2, dx2 = x3 - x2;
+    auto dy1 = y1 - y2, dy2 = y3 - y2;
+    auto det = dx1 * dy2 - dx2 * dy1;
+
+    if ((sx == 0 && sy == 0) || det == 0) {
+        unit.g = 0;
+        unit.h = 0;
+    } else {
+        unit.g = (sx * dy2 - dx2 * sy) / det;
+        unit.h = (dx1 * sy - sx * dy1) / det;
+    }
+
+    unit.a = x1 - x0 + unit.g * x1;
+    unit.b = x3 - x0 + unit.h * x3;
+    unit.c = x0;
+    unit.d = y1 - y0 + unit.g * y1;
+    unit.e = y3 - y0 + unit.h * y3;
+    unit.f = y0;
+
+    auto u = 1.0 / std::max(1, width - 1);
+    auto v = 1.0 / std::max(1, height - 1);
+
+    Homography result = unit;
+    result.a *= u;
+    result.d *= u;
+    result.g *= u;
+    result.b *= v;
+    result.e *= v;
+    result.h *= v;
+
+    return result;
+}
+
+void StraightSize(const Quad &quad, int &width, int &height)
+{
+    width = static_cast<int>(std::max(Distance(quad[0], quad[1]), Distance(quad[3], quad[2])));
+    height = static_cast<int>(std::max(Distance(quad[0], quad[3]), Distance(quad[1], quad[2])));
+}
+
+float Tilt(const Quad &quad)
+{
+    auto ratio = [](float a, float b) {
+        auto longer = std::max(a, b);
+        return longer > 0 ? 1 - std::min(a, b) / longer : 1.0f;
+    };
+
+    return std::max(ratio(Distance(quad[0], quad[1]), Distance(quad[3], quad[2])),
+                    ratio(Distance(quad[0], quad[3]), Distance(quad[1], quad[2])));
+}
+
+Image Warp(const Plane &src, const Quad &quad, int width, int height, ThreadPool *pool)
+{
+    Image result(std::max(0, width), std::max(0, height));
+    if (result.IsEmpty() || src.width <= 0 || src.height <= 0) {
+        return Image();
+    }
+
+    auto map = RectToQuad(quad, width, height);
+    auto maxX = static_cast<float>(src.width - 1);
+    auto maxY = static_cast<float>(src.height - 1);
+
+    // Coordinates and weights of a row come from plain loops over
+    // arrays, vectorised by the compiler; the four pixel fetches are a
+    // gather, neither SSE2 nor NEON has one, they stay scalar
+    auto warpStrip = [&](size_t strip) {
+        auto first = static_cast<int>(strip) * WarpStrip;
+        auto last = std::min(height, first + WarpStrip);
+
+        std::vector<float> fx(width);
+        std::vector<float> fy(width);
+        std::vector<int32_t> offset(width);
+        std::vector<int32_t> weightX(width);
+        std::vector<int32_t> weightY(width);
+
+        for (int y = first; y < last; y++) {
+            // The projective map along a row: numerators and the
+            // denominator grow by a, d and g per pixel
+            auto baseX = static_cast<float>(map.b * y + map.c);
+            auto baseY = static_cast<float>(map.e * y + map.f);
+            auto baseW = static_cast<float>(map.h * y + 1);
+            auto stepX = static_cast<float>(map.a);
+            auto stepY = static_cast<float>(map.d);
+            auto stepW = static_cast<float>(map.g);
+
+            for (int x = 0; x < width; x++) {
+                auto inverse = 1 / (baseW + stepW * x);
+                auto px = (baseX + stepX * x) * inverse;
+                auto py = (baseY + stepY * x) * inverse;
+                fx[x] = std::min(std::max(px, 0.0f), maxX);
+                fy[x] = std::min(std::max(py, 0.0f), maxY);
+            }
+
+            // 8-bit fractions, the pixel right of or below the last
+            // one is the last one with a zero weight
+            for (int x = 0; x < width; x++) {
+                auto ix = static_cast<int32_t>(fx[x]);
+                auto iy = static_cast<int32_t>(fy[x]);
+                weightX[x] = static_cast<int32_t>((fx[x] - ix) * WarpOne + 0.5f);
+                weightY[x] = static_cast<int32_t>((fy[x] - iy) * WarpOne + 0.5f);
+                offset[x] = iy * src.stride + ix;
+            }
+
+            auto out = result.Row(y);
+            for (int x = 0; x < width; x++) {
+                auto pixel = src.data + offset[x];
+                auto right = weightX[x] > 0 ? 1 : 0;
+                auto down = weightY[x] > 0 ? src.stride : 0;
+                auto upper = pixel[0] * (WarpOne - weightX[x]) + pixel[right] * weightX[x];
+                auto lower = pixel[down] * (WarpOne - weightX[x]) + pixel[down + right] * weightX[x];
+                auto value = upper * (WarpOne - weightY[x]) + lower * weightY[x];
+                out[x] = static_cast<uint8_t>((value + WarpOne * WarpOne / 2) >> 16);
+            }
+        }
+    };
+
+    auto strips = static_cast<size_t>((height + WarpStrip - 1) / WarpStrip);
+    if (pool && strips > 1) {
+        pool->ParallelFor(strips, warpStrip);
+    } else {
+        for (size_t strip = 0; strip < strips; strip++) {
+            warpStrip(strip);
+        }
+    }
+
+    return result;
+}
+
+} // namespace omr
@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/qr_analyzer.h>
+
+#include <libyuv/libyuv.h>
+
+#include <algorithm>
+
+#include "ZXing/ReadBarcode.h"
+
+namespace {
+
+// 720p
+constexpr int MaxLongEdge = 1280;
+
+} // namespace
+
+QrAnalyzer::QrAnalyzer(const Handler &onResult)
+    : m_onResult(onResult)
+{}
+
+std::string QrAnalyzer::Name() const
+{
+    return AnalyzerName;
+}
+
+void QrAnalyzer::Analyze(const FrameView &frame)
+{
+    auto data = frame.y;
+    auto stride = frame.strideY;
+    auto width = frame.width;
+    auto height = frame.height;
+    auto longEdge = std::max(width, height);
+
+    // Luminance is all ZXing reads, no colour conversion is needed
+    if (longEdge > MaxLongEdge) {
+        width = std::max(1, frame.width * MaxLongEdge / longEdge);
+        height = std::max(1, frame.height * MaxLongEdge / longEdge);
+        m_scaled.resize(static_cast<size_t>(width) * height);
+        libyuv::ScalePlane(frame.y, frame.strideY, frame.width, frame.height,
+                           m_scaled.data(), width, width, height, libyuv::kFilterBox);
+        data = m_scaled.data();
+        stride = width;
+    }
+
+    auto image = ZXing::ImageView(data, width, height, ZXing::ImageFormat::Lum, stride);
+
+    #if PSDK_MAJOR == 5
+        auto hints = ZXing::DecodeHints().setFormats(ZXing::BarcodeFormat::QRCode);
+    #else
+        auto hints = ZXing::DecodeHints().setFormats(ZXing::BarcodeFormat::QR_CODE);
+    #endif
+
+    auto result = ZXing::ReadBarcode(image, hints);
+    if (result.isValid()) {
+        auto ws = result.text();
+        m_onResult(std::string(ws.begin(), ws.end()));
+    } else {
+        m_onResult("");
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/serial_queue.h>
+
+SerialQueue::SerialQueue(ThreadPool *pool)
+    : m_pool(pool)
+    , m_state(std::make_shared<State>())
+{}
+
+void SerialQueue::Post(ThreadPool::Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->tasks.push_back(std::move(task));
+
+        if (m_state->running) {
+            return;
+        }
+
+        m_state->running = true;
+    }
+
+    auto pool = m_pool;
+    auto state = m_state;
+    m_pool->Post([pool, state] { RunNext(pool, state); });
+}
+
+void SerialQueue::RunNext(ThreadPool *pool, std::shared_ptr<State> state)
+{
+    ThreadPool::Task task;
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        task = std::move(state->tasks.front());
+        state->tasks.pop_front();
+    }
+
+    task();
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+
+        if (state->tasks.empty()) {
+            state->running = false;
+            return;
+        }
+    }
+
+    pool->Post([pool, state] { RunNext(pool, state); });
+}
@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/sheet_analyzer.h>
+#include <camera_aurora/omr/corners.h>
+#include <camera_aurora/omr/warp.h>
+#include <camera_aurora/trace.h>
+#include <camera_aurora/yuv_metrics.h>
+
+#include <algorithm>
+#include <cmath>
+
+SheetAnalyzer::SheetAnalyzer(const Handler &onSheet, size_t frames)
+    : m_onSheet(onSheet)
+    , m_tracker(frames)
+{}
+
+std::string SheetAnalyzer::Name() const
+{
+    return AnalyzerName;
+}
+
+void SheetAnalyzer::Analyze(const FrameView &frame)
+{
+    trace::Scope span("sheet.detect");
+
+    Sheet sheet;
+    sheet.sequence = frame.sequence;
+
+    omr::Plane plane{frame.y, frame.width, frame.height, frame.strideY};
+    sheet.found = omr::FindCorners(plane, sheet.corners, SearchSize);
+
+    if (!sheet.found) {
+        m_tracker.Reset();
+        if (!m_lost) {
+            m_lost = true;
+            m_onSheet(sheet);
+        }
+        return;
+    }
+
+    sheet.tilt = omr::Tilt(sheet.corners);
+
+    // Focus of the sheet, not of what is around it
+    auto left = frame.width, top = frame.height, right = 0, bottom = 0;
+    for (const auto &corner : sheet.corners) {
+        left = std::min(left, static_cast<int>(corner.x));
+        top = std::min(top, static_cast<int>(corner.y));
+        right = std::max(right, static_cast<int>(std::ceil(corner.x)));
+        bottom = std::max(bottom, static_cast<int>(std::ceil(corner.y)));
+    }
+    left = std::max(left, 0);
+    top = std::max(top, 0);
+    right = std::min(right, frame.width);
+    bottom = std::min(bottom, frame.height);
+
+    if (right - left > 2 && bottom - top > 2) {
+        sheet.sharpness = yuv::Sharpness(frame.y + static_cast<ptrdiff_t>(top) * frame.strideY + left,
+                                         frame.strideY, right - left, bottom - top);
+    }
+
+    for (auto &corner : sheet.corners) {
+        corner.x /= frame.width;
+        corner.y /= frame.height;
+    }
+
+    m_tracker.Add(sheet.corners);
+    sheet.jitter = m_tracker.Jitter();
+    sheet.stability = m_tracker.Stability();
+    m_lost = false;
+
+    m_onSheet(sheet);
+}
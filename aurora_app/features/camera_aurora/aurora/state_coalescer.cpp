@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/state_coalescer.h>
+
+// EncodableValue is ordered for map keys, equality is derived from it
+static bool IsSame(const EncodableValue &a, const EncodableValue &b)
+{
+    return !(a < b) && !(b < a);
+}
+
+void StateCoalescer::Merge(const EncodableMap &state)
+{
+    m_pending = state;
+    m_hasPending = true;
+}
+
+EncodableMap StateCoalescer::TakeDelta()
+{
+    EncodableMap delta;
+
+    if (!m_hasPending) {
+        return delta;
+    }
+
+    for (const auto &item : m_pending) {
+        auto sent = m_sent.find(item.first);
+        if (sent == m_sent.end() || !IsSame(sent->second, item.second)) {
+            delta.emplace(item.first, item.second);
+        }
+    }
+
+    for (const auto &item : m_sent) {
+        if (m_pending.find(item.first) == m_pending.end()) {
+            delta.emplace(item.first, EncodableValue());
+        }
+    }
+
+    m_sent = std::move(m_pending);
+    m_pending.clear();
+    m_hasPending = false;
+
+    return delta;
+}
+
+void StateCoalescer::Reset()
+{
+    m_sent.clear();
+}
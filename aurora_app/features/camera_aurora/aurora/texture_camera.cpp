@@ -3,38 +3,180 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 #include <camera_aurora/texture_camera.h>
+#include <camera_aurora/qr_analyzer.h>
+#include <camera_aurora/trace.h>
 #include <camera_aurora/yuv.h>
+#include <camera_aurora/yuv_metrics.h>
 #include <camera_aurora/yuv_i420.h>
 #include <camera_aurora/yuv_nv12.h>
 
+#include <algorithm>
 #include <iostream>
 
-#include "ZXing/ReadBarcode.h"
+
+// Upper bound of memory held by the pre-capture ring and the burst
+constexpr size_t PreCaptureMemoryCap = 64 * 1024 * 1024;
+constexpr size_t BurstMemoryCap = 128 * 1024 * 1024;
+
+// QR search rate, about every 15th frame at 30 fps
+constexpr std::chrono::milliseconds SearchQrInterval(500);
+
+// The planes of a mapped frame point into the camera buffer, both are
+// kept while the analyzers read them
+struct MappedFrame
+{
+    std::shared_ptr<Aurora::StreamCamera::GraphicBuffer> buffer;
+    std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame;
+};
 
 TextureCamera::TextureCamera(TextureRegistrar* texture_registrar,
+                             ThreadPool* pool,
+                             FrameBudget* budget,
                              const CameraErrorHandler &onError,
-                             const ChangeQRHandler &onChangeQR)
+                             const ChangeQRHandler &onChangeQR,
+                             const CaptureResultHandler &onCaptureResult,
+                             const FrameStreamHandler &onStreamFrame)
     : m_textures(texture_registrar)
+    , m_pool(pool)
+    , m_budget(budget)
     , m_onError(onError)
     , m_onChangeQR(onChangeQR)
+    , m_onCaptureResult(onCaptureResult)
+    , m_onStreamFrame(onStreamFrame)
     , m_manager(StreamCameraManager())
     , m_camera(nullptr)
+    , m_preCapture(PreCaptureMemoryCap)
+    , m_stream(std::make_shared<FrameStream>())
+    , m_stats(std::make_shared<FrameStats>())
+    , m_analyzers(pool, m_stats)
+    , m_burst(BurstMemoryCap)
 {}
 
-void TextureCamera::GetImageBase64(const TakeImageBase64Handler &takeImageBase64)
+// Requests are written under m_requestMutex and flagged after it: the
+// camera thread copies them when it sees the flag and clears the flag
+// when done. A pending request of the same kind is not replaced.
+
+void TextureCamera::GetImageBase64(const CaptureHandler &takeImageBase64)
 {
-    m_takeImageBase64 = takeImageBase64;
+    if (m_isTakeImageBase64) {
+        takeImageBase64(CaptureTimeline(), "");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_still = CaptureRequest{takeImageBase64, CaptureTimeline(CaptureTimeline::NextId()),
+                                 FrameRing::Clock::now(), 0};
+        m_still.timeline.Mark("requested");
+    }
     m_isTakeImageBase64 = true;
 }
 
+void TextureCamera::GetProgressiveImageBase64(int thumbnail, const CaptureHandler &takeThumbnail)
+{
+    if (m_isTakeProgressive) {
+        takeThumbnail(CaptureTimeline(), "");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_progressive = CaptureRequest{takeThumbnail, CaptureTimeline(CaptureTimeline::NextId()),
+                                       FrameRing::Clock::now(), thumbnail};
+        m_progressive.timeline.Mark("requested");
+    }
+    m_isTakeProgressive = true;
+}
+
+void TextureCamera::GetBurstImageBase64(int count,
+                                        int interval,
+                                        const TakeImageBase64Handler &takeBurst)
+{
+    if (m_isTakeBurst || m_isBurstBusy || count <= 0) {
+        takeBurst("");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_takeBurst = takeBurst;
+        m_burstInterval = std::chrono::milliseconds(interval < 0 ? 0 : interval);
+        m_burstNext = FrameRing::Clock::now();
+    }
+    m_burst.Configure(count);
+    m_isTakeBurst = true;
+}
+
+void TextureCamera::GradeSheet(const omr::AnswerKey &key,
+                               const std::shared_ptr<const omr::CompiledLayout> &layout,
+                               const GradeHandler &onGrade)
+{
+    if (m_isGrade) {
+        omr::Result busy;
+        busy.error = "Sheet grading in progress";
+        onGrade(busy);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_grade = GradeRequest{key, layout, onGrade, FrameRing::Clock::now()};
+    }
+    m_isGrade = true;
+}
+
+void TextureCamera::SetPreCapture(int frames)
+{
+    // The ring has a lock of its own
+    m_preCapture.Configure(frames);
+}
+
+void TextureCamera::SetOutput(const yuv::OutputOptions &options)
+{
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_output = options;
+}
+
+yuv::OutputOptions TextureCamera::Output()
+{
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    return m_output;
+}
+
+void TextureCamera::StartImageStream(const FrameStream::Options &options)
+{
+    m_stream->Start(options);
+}
+
+void TextureCamera::StopImageStream()
+{
+    m_stream->Stop();
+}
+
+void TextureCamera::ReleaseFrame(int slot, int64_t sequence)
+{
+    m_stream->Release(slot, sequence);
+}
+
+bool TextureCamera::IsImageStream() const
+{
+    return m_stream->IsEnabled();
+}
+
+std::shared_ptr<FrameStream> TextureCamera::ImageStream() const
+{
+    return m_stream;
+}
+
 EncodableList TextureCamera::GetAvailableCameras()
 {
     EncodableList cameras;
-    auto count = m_manager->getNumberOfCameras();
+    auto manager = StreamCameraManager();
+    auto count = manager->getNumberOfCameras();
 
     for (int index = 0; index < count; index++) {
         Aurora::StreamCamera::CameraInfo info;
-        if (m_manager->getCameraInfo(index, info)) {
+        if (manager->getCameraInfo(index, info)) {
             cameras.push_back(EncodableMap{
                 {"id", info.id},
                 {"name", info.name},
@@ -50,11 +192,19 @@ EncodableList TextureCamera::GetAvailableCameras()
 EncodableMap TextureCamera::GetState()
 {
     if (m_camera) {
+        int width = 0;
+        int height = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_requestMutex);
+            width = m_requestWidth;
+            height = m_requestHeight;
+        }
+
         return EncodableMap{
             {"id", m_info.id},
             {"textureId", m_textureId},
-            {"width", m_captureWidth},
-            {"height", m_captureHeight},
+            {"width", width},
+            {"height", height},
             {"mountAngle", m_info.mountAngle},
             {"rotationDisplay", static_cast<int>(aurora::GetOrientation())},
             {"error", m_error},
@@ -64,6 +214,16 @@ EncodableMap TextureCamera::GetState()
     return EncodableMap{{"error", m_error}};
 }
 
+int64_t TextureCamera::CameraId() const
+{
+    return m_cameraId;
+}
+
+std::string TextureCamera::CameraName() const
+{
+    return m_cameraName;
+}
+
 bool TextureCamera::CreateCamera(std::string cameraName)
 {
     if (m_camera) {
@@ -98,7 +258,7 @@ bool TextureCamera::CreateCamera(std::string cameraName)
 void TextureCamera::SendError(std::string error)
 {
     m_error = error;
-    m_onError();
+    m_onError(m_cameraId);
 }
 
 EncodableMap TextureCamera::StartCapture(int width, int height)
@@ -107,7 +267,7 @@ EncodableMap TextureCamera::StartCapture(int width, int height)
         m_viewWidth = width;
         m_viewHeight = height;
 
-        ResizeFrame(width, height, m_info, m_cap, m_captureWidth, m_captureHeight);
+        RequestSize(width, height);
 
         m_isStart = m_camera->startCapture(m_cap);
 
@@ -131,7 +291,7 @@ void TextureCamera::StopCapture()
         std::this_thread::sleep_for(
             std::chrono::milliseconds(m_chromaStep == 1 ? 10 : 500 /* r7 */));
         index++;
-    } while (m_isTakeImageBase64 && index < 200);
+    } while ((m_isTakeImageBase64 || m_isTakeProgressive || m_isGrade || m_isTakeAuto) && index < 200);
 
     if (m_camera && m_camera->captureStarted()) {
         m_camera->stopCapture();
@@ -141,16 +301,34 @@ void TextureCamera::StopCapture()
 
 EncodableMap TextureCamera::Register(std::string cameraName)
 {
+    // The engine may still ask for a frame after the camera is gone
     m_textureVariant = std::make_shared<TextureVariant>(PixelBufferTexture(
-        [this](size_t, size_t) -> const FlutterDesktopPixelBuffer* {
+        [weak = weak_from_this()](size_t, size_t) -> const FlutterDesktopPixelBuffer* {
+            auto self = weak.lock();
+            if (!self) {
+                return nullptr;
+            }
+            auto marked = self->m_availableAt.exchange(0, std::memory_order_relaxed);
+            if (marked != 0) {
+                self->m_stats->Record(FrameStats::Stage::Pull,
+                                      FrameStats::Clock::now().time_since_epoch()
+                                          - FrameStats::Clock::duration(marked));
+            }
+            // One load: the pixels and their size come from the same frame
+            auto preview = std::atomic_load(&self->m_preview);
+            if (!preview) {
+                return nullptr;
+            }
             return new FlutterDesktopPixelBuffer {
-                m_bits.get(),
-                (size_t) m_captureWidth,
-                (size_t) m_captureHeight
+                preview->bits.get(),
+                (size_t) preview->width,
+                (size_t) preview->height
             };
         }));
 
     m_textureId = m_textures->RegisterTexture(m_textureVariant.get());
+    m_cameraId = m_textureId;
+    m_cameraName = cameraName;
 
     if (CreateCamera(cameraName) && m_viewWidth != 0) {
         StartCapture(m_viewWidth, m_viewHeight);
@@ -161,7 +339,7 @@ EncodableMap TextureCamera::Register(std::string cameraName)
 
 EncodableMap TextureCamera::Unregister()
 {
-    m_bits = nullptr;
+    std::atomic_store(&m_preview, std::shared_ptr<const Preview>());
 
     if (m_camera) {
         m_isStart = false;
@@ -170,26 +348,82 @@ EncodableMap TextureCamera::Unregister()
         m_camera = nullptr;
     }
 
-    m_textures->UnregisterTexture(m_textureId);
+    // Zero after a failed start, which unregistered already
+    if (m_textureId != 0) {
+        m_textures->UnregisterTexture(m_textureId);
+    }
+    m_preCapture.Clear();
+
+    // The camera is stopped, nothing takes the requests any more
+    TakeImageBase64Handler takeBurst;
+    CaptureRequest still;
+    CaptureRequest progressive;
+    GradeRequest grade;
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        takeBurst = m_takeBurst;
+        still = m_still;
+        progressive = m_progressive;
+        grade = m_grade;
+        m_requestWidth = 0;
+        m_requestHeight = 0;
+        m_isResize = true;
+    }
+
+    if (m_isTakeBurst) {
+        m_isTakeBurst = false;
+        takeBurst("");
+    }
+
+    if (m_isTakeImageBase64) {
+        m_isTakeImageBase64 = false;
+        still.handler(CaptureTimeline(), "");
+    }
+
+    if (m_isTakeProgressive) {
+        m_isTakeProgressive = false;
+        progressive.handler(CaptureTimeline(), "");
+    }
+
+    m_isTakeAuto = false;
+
+    if (m_isGrade) {
+        m_isGrade = false;
+        omr::Result closed;
+        closed.error = "Camera closed";
+        grade.handler(closed);
+    }
 
     m_error = "";
     m_counter = 0;
-    m_counter_qr = 0;
     m_textureId = 0;
-    m_captureWidth = 0;
-    m_captureHeight = 0;
 
     return GetState();
 }
 
 EncodableMap TextureCamera::ResizeFrame(int width, int height)
 {
-    if (m_isStart && !(width == m_captureWidth || height == m_captureHeight)) {
-        ResizeFrame(width, height, m_info, m_cap, m_captureWidth, m_captureHeight);
+    if (m_isStart) {
+        RequestSize(width, height);
     }
     return GetState();
 }
 
+void TextureCamera::RequestSize(int width, int height)
+{
+    int captureWidth = 0;
+    int captureHeight = 0;
+    ResizeFrame(width, height, m_info, m_cap, captureWidth, captureHeight);
+
+    // The camera thread takes the size with the next frame
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    if (captureWidth != m_requestWidth || captureHeight != m_requestHeight) {
+        m_requestWidth = captureWidth;
+        m_requestHeight = captureHeight;
+        m_isResize = true;
+    }
+}
+
 void TextureCamera::ResizeFrame(int width,
                                 int height,
                                 Aurora::StreamCamera::CameraInfo info,
@@ -219,8 +453,6 @@ void TextureCamera::ResizeFrame(int width,
         ch = cap.width;
     }
 
-    m_bits = nullptr;
-
     captureHeight = dh;
     captureWidth = (cw * dh) / ch;
 
@@ -233,36 +465,99 @@ void TextureCamera::ResizeFrame(int width,
 std::optional<std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame>> TextureCamera::GetFrame(
     std::shared_ptr<Aurora::StreamCamera::GraphicBuffer> buffer)
 {
-    auto frame = buffer->mapYCbCr();
+    auto start = m_stats->Now();
+    std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame;
+    {
+        trace::Scope span("map");
+        frame = buffer->mapYCbCr();
+    }
+    m_stats->Record(FrameStats::Stage::Map, start);
+
+    // Cheap: the preview goes on while the full image is encoded
+    if (m_isTakeProgressive) {
+        CaptureRequest request;
+        {
+            std::lock_guard<std::mutex> lock(m_requestMutex);
+            request = m_progressive;
+        }
+        request.timeline.Mark("frame");
+        TakeProgressive(frame, request);
+        m_isTakeProgressive = false;
+    }
+
+    if (m_isGrade) {
+        GradeRequest request;
+        {
+            std::lock_guard<std::mutex> lock(m_requestMutex);
+            request = m_grade;
+        }
+        TakeGrade(frame, request);
+        m_isGrade = false;
+    }
+
+    if (m_isTakeAuto) {
+        // Set by the analyzer worker under the mutex
+        CaptureTimeline timeline;
+        FrameRing::Clock::time_point time;
+        {
+            std::lock_guard<std::mutex> lock(m_sheetMutex);
+            timeline = m_autoTimeline;
+            time = m_autoTime;
+        }
+        timeline.Mark("frame");
+        TakeAuto(frame, timeline, time);
+        m_isTakeAuto = false;
+    }
 
     if (m_isTakeImageBase64) {
-        std::string base64 = "";
+        CaptureRequest request;
+        {
+            std::lock_guard<std::mutex> lock(m_requestMutex);
+            request = m_still;
+        }
+        request.timeline.Mark("frame");
+        auto base64 = TakeImageBase64(frame, request.time);
+        request.timeline.Mark("encoded");
+        request.handler(request.timeline, base64);
+        m_isTakeImageBase64 = false;
+        m_stats->CountDrop(FrameStats::Drop::Capture);
+        return std::nullopt;
+    }
 
+    if (m_isTakeBurst) {
+        TakeBurstFrame(frame);
+    }
+
+    if (m_preCapture.IsEnabled()) {
         if (frame->chromaStep == 1 /* I420 */) {
-            base64 = yuv::YUVToBase64(frame->y,
-                                      frame->cr,
-                                      frame->cb,
-                                      frame->width,
-                                      frame->height,
-                                      static_cast<int>(aurora::GetOrientation()),
-                                      m_info.mountAngle,
-                                      m_info.id.find("front") != std::string::npos ? -1 : 1);
+            m_preCapture.Push(frame->y, frame->yStride, frame->cr, frame->cStride,
+                              frame->cb, frame->cStride, frame->width, frame->height);
+        } else if (frame->chromaStep == 2 /* NV12 */) {
+            m_preCapture.Push(frame->y, frame->yStride, frame->cr, frame->cStride,
+                              nullptr, 0, frame->width, frame->height);
         }
+    }
 
-        else if (frame->chromaStep == 2 /* NV12 */) {
-            base64 = yuv::YUVToBase64(frame->y,
-                                      frame->cr,
-                                      nullptr,
-                                      frame->width,
-                                      frame->height,
-                                      static_cast<int>(aurora::GetOrientation()),
-                                      m_info.mountAngle,
-                                      m_info.id.find("front") != std::string::npos ? -1 : 1);
+    if (m_stream->IsEnabled()) {
+        FrameStream::Frame streamFrame;
+        auto pushed = false;
+        auto dropped = m_stream->Dropped();
+
+        if (frame->chromaStep == 1 /* I420 */) {
+            pushed = m_stream->Push(frame->y, frame->yStride, frame->cr, frame->cStride,
+                                    frame->cb, frame->cStride, frame->width, frame->height,
+                                    streamFrame);
+        } else if (frame->chromaStep == 2 /* NV12 */) {
+            pushed = m_stream->Push(frame->y, frame->yStride, frame->cr, frame->cStride,
+                                    nullptr, 0, frame->width, frame->height, streamFrame);
         }
 
-        m_takeImageBase64(base64);
-        m_isTakeImageBase64 = false;
-        return std::nullopt;
+        if (pushed) {
+            m_onStreamFrame(m_cameraId, streamFrame);
+        } else if (m_stream->Dropped() != dropped) {
+            m_stats->CountDrop(FrameStats::Drop::Stream);
+            trace::Counter("stream.dropped", static_cast<int64_t>(dropped + 1));
+        }
     }
 
     m_counter += 1;
@@ -272,27 +567,407 @@ std::optional<std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame>> TextureCa
     }
 
     if (m_counter % 3 == 0) {
+        m_stats->CountDrop(FrameStats::Drop::Decimate);
         return std::nullopt;
     }
 
     return frame;
 }
 
+std::string TextureCamera::Encode(const uint8_t *y,
+                                  int strideY,
+                                  const uint8_t *u,
+                                  const uint8_t *v,
+                                  int width,
+                                  int height,
+                                  int orientation,
+                                  int mountAngle,
+                                  int direction,
+                                  const yuv::OutputOptions &options)
+{
+    if (options.format != yuv::OutputFormat::Jpeg) {
+        return yuv::YToBase64(y, strideY, width, height, orientation, mountAngle, direction, options, m_pool);
+    }
+
+    return yuv::YUVToBase64(y, u, v, width, height, orientation, mountAngle, direction, m_pool);
+}
+
+std::string TextureCamera::TakeImageBase64(
+    std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame, FrameRing::Clock::time_point time)
+{
+    trace::Scope span("capture.still");
+
+    auto orientation = static_cast<int>(aurora::GetOrientation());
+    auto direction = m_info.id.find("front") != std::string::npos ? -1 : 1;
+    auto output = Output();
+
+    // Zero shutter lag: the sharpest frame before the tap
+    if (m_preCapture.IsEnabled()) {
+        if (auto slot = m_preCapture.Sharpest(time)) {
+            return Encode(slot->y,
+                          slot->width,
+                          slot->u,
+                          slot->v,
+                          slot->width,
+                          slot->height,
+                          orientation,
+                          m_info.mountAngle,
+                          direction,
+                          output);
+        }
+    }
+
+    if (frame->chromaStep == 1 /* I420 */) {
+        return Encode(frame->y,
+                      frame->yStride,
+                      frame->cr,
+                      frame->cb,
+                      frame->width,
+                      frame->height,
+                      orientation,
+                      m_info.mountAngle,
+                      direction,
+                      output);
+    }
+
+    if (frame->chromaStep == 2 /* NV12 */) {
+        return Encode(frame->y,
+                      frame->yStride,
+                      frame->cr,
+                      nullptr,
+                      frame->width,
+                      frame->height,
+                      orientation,
+                      m_info.mountAngle,
+                      direction,
+                      output);
+    }
+
+    return "";
+}
+
+void TextureCamera::TakeBurstFrame(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame)
+{
+    auto now = FrameRing::Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        if (now < m_burstNext) {
+            return;
+        }
+        m_burstNext = now + m_burstInterval;
+    }
+
+    // Copy only, the frames are scored on the workers
+    if (frame->chromaStep == 1 /* I420 */) {
+        m_burst.Push(frame->y, frame->yStride, frame->cr, frame->cStride,
+                     frame->cb, frame->cStride, frame->width, frame->height, false);
+    } else if (frame->chromaStep == 2 /* NV12 */) {
+        m_burst.Push(frame->y, frame->yStride, frame->cr, frame->cStride,
+                     nullptr, 0, frame->width, frame->height, false);
+    }
+
+    auto count = m_burst.Filled();
+
+    if (count == 0 || count < m_burst.Size()) {
+        return;
+    }
+
+    // Busy first: a new burst is refused until this one is delivered
+    m_isBurstBusy = true;
+    m_isTakeBurst = false;
+
+    auto orientation = static_cast<int>(aurora::GetOrientation());
+    auto direction = m_info.id.find("front") != std::string::npos ? -1 : 1;
+    auto mountAngle = m_info.mountAngle;
+
+    TakeImageBase64Handler takeBurst;
+    yuv::OutputOptions output;
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        takeBurst = m_takeBurst;
+        output = m_output;
+    }
+
+    // The handler goes by value, the next burst may set another one
+    m_pool->Post([this, self = shared_from_this(), takeBurst, count, orientation,
+                  direction, mountAngle, output] {
+        trace::NameThread("worker");
+        trace::Scope span("burst.select");
+        m_pool->ParallelFor(count, [this](size_t index) {
+            auto slot = m_burst.At(index);
+            slot->sharpness = yuv::FrameScore(slot->y, slot->width, slot->width, slot->height);
+        });
+
+        const FrameRing::Slot *best = nullptr;
+
+        for (size_t index = 0; index < count; index++) {
+            auto slot = m_burst.At(index);
+            if (!best || slot->sharpness > best->sharpness) {
+                best = slot;
+            }
+        }
+
+        // Only the winner is encoded
+        auto base64 = Encode(best->y,
+                             best->width,
+                             best->u,
+                             best->v,
+                             best->width,
+                             best->height,
+                             orientation,
+                             mountAngle,
+                             direction,
+                             output);
+
+        m_burst.Release();
+        m_isBurstBusy = false;
+        takeBurst(base64);
+    });
+}
+
+void TextureCamera::TakeProgressive(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                                    const CaptureRequest &request)
+{
+    trace::Scope span("capture.thumbnail");
+
+    auto timeline = request.timeline;
+    auto orientation = static_cast<int>(aurora::GetOrientation());
+    auto direction = m_info.id.find("front") != std::string::npos ? -1 : 1;
+    auto mountAngle = m_info.mountAngle;
+
+    int width = 0;
+    int height = 0;
+    auto buf = CopyCapture(frame, request.time, width, height);
+
+    if (!buf) {
+        request.handler(timeline, "");
+        return;
+    }
+
+    auto strideUV = (width + 1) / 2;
+    auto sizeY = static_cast<size_t>(width) * height;
+    auto sizeUV = static_cast<size_t>(strideUV) * ((height + 1) / 2);
+
+    auto y = buf.get();
+    auto u = y + sizeY;
+    auto v = u + sizeUV;
+
+    // Thumbnail: box-downscaled to the requested long edge, encoded here
+    auto longEdge = std::max(width, height);
+    auto thumbWidth = width;
+    auto thumbHeight = height;
+
+    if (request.thumbnail > 0 && request.thumbnail < longEdge) {
+        thumbWidth = std::max(2, width * request.thumbnail / longEdge);
+        thumbHeight = std::max(2, height * request.thumbnail / longEdge);
+    }
+
+    auto thumbStrideUV = (thumbWidth + 1) / 2;
+    auto thumbSizeY = static_cast<size_t>(thumbWidth) * thumbHeight;
+    auto thumbSizeUV = static_cast<size_t>(thumbStrideUV) * ((thumbHeight + 1) / 2);
+    auto thumb = std::shared_ptr<uint8_t>((uint8_t *) malloc(thumbSizeY + thumbSizeUV * 2), free);
+
+    auto ty = thumb.get();
+    auto tu = ty + thumbSizeY;
+    auto tv = tu + thumbSizeUV;
+
+    libyuv::I420Scale(y, width, u, strideUV, v, strideUV, width, height,
+                      ty, thumbWidth, tu, thumbStrideUV, tv, thumbStrideUV,
+                      thumbWidth, thumbHeight, libyuv::kFilterBox);
+
+    auto base64 = yuv::YUVToBase64(ty, tu, tv, thumbWidth, thumbHeight,
+                                   orientation, mountAngle, direction);
+    timeline.Mark("thumbnail");
+    request.handler(timeline, base64);
+
+    EncodeCapture(timeline, buf, width, height);
+}
+
+void TextureCamera::TakeAuto(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                             const CaptureTimeline &timeline,
+                             FrameRing::Clock::time_point time)
+{
+    trace::Scope span("capture.auto");
+
+    int width = 0;
+    int height = 0;
+    auto buf = CopyCapture(frame, time, width, height);
+
+    if (!buf) {
+        m_onCaptureResult(m_cameraId, timeline, "");
+        return;
+    }
+
+    EncodeCapture(timeline, buf, width, height);
+}
+
+std::shared_ptr<uint8_t> TextureCamera::CopyCapture(
+    std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+    FrameRing::Clock::time_point time,
+    int &width,
+    int &height)
+{
+    // Same source as TakeImageBase64: the sharpest pre-captured frame
+    // before `time` or this one
+    std::shared_ptr<const FrameRing::Slot> slot;
+
+    if (m_preCapture.IsEnabled()) {
+        slot = m_preCapture.Sharpest(time);
+    }
+
+    if (!slot && frame->chromaStep != 1 && frame->chromaStep != 2) {
+        return nullptr;
+    }
+
+    width = slot ? slot->width : frame->width;
+    height = slot ? slot->height : frame->height;
+
+    auto strideUV = (width + 1) / 2;
+    auto sizeY = static_cast<size_t>(width) * height;
+    auto sizeUV = static_cast<size_t>(strideUV) * ((height + 1) / 2);
+
+    // The camera buffer is given back after this callback, one compact
+    // copy feeds both the thumbnail and the full image
+    auto buf = std::shared_ptr<uint8_t>((uint8_t *) malloc(sizeY + sizeUV * 2), free);
+
+    auto y = buf.get();
+    auto u = y + sizeY;
+    auto v = u + sizeUV;
+
+    if (slot) {
+        libyuv::I420Copy(slot->y, width, slot->u, strideUV, slot->v, strideUV,
+                         y, width, u, strideUV, v, strideUV, width, height);
+    } else if (frame->chromaStep == 1 /* I420 */) {
+        libyuv::I420Copy(frame->y, frame->yStride, frame->cr, frame->cStride,
+                         frame->cb, frame->cStride,
+                         y, width, u, strideUV, v, strideUV, width, height);
+    } else {
+        libyuv::NV12ToI420(frame->y, frame->yStride, frame->cr, frame->cStride,
+                           y, width, u, strideUV, v, strideUV, width, height);
+    }
+
+    return buf;
+}
+
+void TextureCamera::EncodeCapture(const CaptureTimeline &timeline,
+                                  std::shared_ptr<uint8_t> buf,
+                                  int width,
+                                  int height)
+{
+    auto orientation = static_cast<int>(aurora::GetOrientation());
+    auto direction = m_info.id.find("front") != std::string::npos ? -1 : 1;
+    auto mountAngle = m_info.mountAngle;
+    auto output = Output();
+
+    auto y = buf.get();
+    auto u = y + static_cast<size_t>(width) * height;
+    auto v = u + static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+
+    // Full image on the workers, delivered on the capture results channel
+    m_pool->Post([this, self = shared_from_this(), timeline = timeline, buf, y, u, v, width, height, orientation, mountAngle, direction, output]() mutable {
+        trace::NameThread("worker");
+        trace::Scope span("capture.encode");
+        auto image = Encode(y, width, u, v, width, height, orientation, mountAngle, direction, output);
+        timeline.Mark("encoded");
+        m_onCaptureResult(m_cameraId, timeline, image);
+    });
+}
+
+void TextureCamera::TakeGrade(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame,
+                              const GradeRequest &request)
+{
+    trace::Scope span("grade.frame");
+
+    auto orientation = static_cast<int>(aurora::GetOrientation());
+    auto direction = m_info.id.find("front") != std::string::npos ? -1 : 1;
+    auto angle = yuv::RotationAngle(orientation, m_info.mountAngle, direction);
+
+    // Same source as a capture: the sharpest pre-captured frame or this one
+    auto y = frame->y;
+    auto stride = frame->yStride;
+    auto width = frame->width;
+    auto height = frame->height;
+
+    // Pinned until the rotation is done, the ring may be freed meanwhile
+    std::shared_ptr<const FrameRing::Slot> slot;
+    if (m_preCapture.IsEnabled()) {
+        slot = m_preCapture.Sharpest(request.time);
+    }
+    if (slot) {
+        y = slot->y;
+        stride = slot->width;
+        width = slot->width;
+        height = slot->height;
+    }
+
+    // Upright like the photo aurora_cv gets, only the luma is graded
+    auto turned = angle == 90 || angle == 270;
+    auto image = std::make_shared<omr::Image>(turned ? height : width, turned ? width : height);
+    libyuv::RotatePlane(y, stride, image->data.data(), image->width, width, height,
+                        static_cast<libyuv::RotationMode>(angle));
+
+    m_pool->Post([pool = m_pool, image, key = request.key, layout = request.layout, onGrade = request.handler] {
+        trace::NameThread("worker");
+        onGrade(layout ? omr::Grade(image->View(), *layout, key, pool) : omr::Grade(image->View(), key, pool));
+    });
+}
+
 void TextureCamera::onCameraFrame(std::shared_ptr<Aurora::StreamCamera::GraphicBuffer> buffer)
 {
-    if (!m_isStart && !m_isTakeImageBase64) {
+    if (!m_isStart && !m_isTakeImageBase64 && !m_isTakeBurst && !m_isTakeProgressive && !m_isGrade
+        && !m_isTakeAuto) {
         return;
     }
 
+    trace::NameThread("camera");
+    trace::Scope span("frame");
+
+    if (m_isResize) {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        m_captureWidth = m_requestWidth;
+        m_captureHeight = m_requestHeight;
+        m_isResize = false;
+    }
+
+    auto arrival = m_stats->Now();
+    m_stats->CountIn();
+
     if (auto optional = GetFrame(buffer)) {
         auto frame = optional.value();
 
         m_chromaStep = frame->chromaStep;
 
-        if (m_enableSearchQr) {
-            SearchQr(frame);
+        // Analyzers read the mapped frame in place on the workers, the
+        // buffer goes back to the camera once the last one is done
+        if (!m_analyzers.IsEmpty() && (frame->chromaStep == 1 || frame->chromaStep == 2)) {
+            auto isI420 = frame->chromaStep == 1;
+            FrameView view{frame->y,
+                           frame->cr,
+                           isI420 ? frame->cb : nullptr,
+                           frame->yStride,
+                           frame->cStride,
+                           frame->width,
+                           frame->height,
+                           isI420 ? FrameView::Layout::I420 : FrameView::Layout::NV12,
+                           m_sequence++,
+                           FrameView::Clock::now()};
+            m_analyzers.Dispatch(view, std::make_shared<const MappedFrame>(MappedFrame{buffer, frame}));
         }
 
+        // Cameras share the conversion budget evenly
+        if (!m_budgetAccount.Allow(*m_budget)) {
+            m_stats->CountDrop(FrameStats::Drop::Budget);
+            return;
+        }
+
+        trace::Scope preview("preview");
+
+        auto start = FrameBudget::Clock::now();
+        auto time = m_stats->Now();
+        size_t allocated = 0;
+        Preview pixels{nullptr, 0, 0};
+
         if (frame->chromaStep == 1 /* I420 */) {
             auto result = yuv::I420Scale(frame->y,
                                          frame->cr,
@@ -301,7 +976,12 @@ void TextureCamera::onCameraFrame(std::shared_ptr<Aurora::StreamCamera::GraphicB
                                          frame->height,
                                          m_captureWidth,
                                          m_captureHeight);
-            m_bits = yuv::I420ToARGB(result.y, result.u, result.v, result.width, result.height);
+            time = m_stats->Record(FrameStats::Stage::Scale, time);
+            trace::Scope convert("convert");
+            pixels = Preview{yuv::I420ToARGB(result.y, result.u, result.v, result.width, result.height),
+                             result.width,
+                             result.height};
+            allocated = static_cast<size_t>(result.width) * result.height * 11 / 2;
         } else if (frame->chromaStep == 2 /* NV12 */) {
             auto result = yuv::NV12Scale(frame->y,
                                          frame->cr,
@@ -309,7 +989,26 @@ void TextureCamera::onCameraFrame(std::shared_ptr<Aurora::StreamCamera::GraphicB
                                          frame->height,
                                          m_captureWidth,
                                          m_captureHeight);
-            m_bits = yuv::NV12ToARGB(result.y, result.uv, result.width, result.height);
+            time = m_stats->Record(FrameStats::Stage::Scale, time);
+            trace::Scope convert("convert");
+            pixels = Preview{yuv::NV12ToARGB(result.y, result.uv, result.width, result.height),
+                             result.width,
+                             result.height};
+            allocated = static_cast<size_t>(result.width) * result.height * 11 / 2;
+        }
+
+        std::atomic_store(&m_preview, std::make_shared<const Preview>(pixels));
+        m_stats->Record(FrameStats::Stage::Convert, time);
+        m_stats->CountAllocated(allocated);
+        trace::Counter("preview.bytes", static_cast<int64_t>(allocated));
+
+        m_budgetAccount.Spend(FrameBudget::Clock::now() - start);
+
+        // Before marking: the engine may pull the frame right away
+        if (arrival != FrameStats::Clock::time_point()) {
+            auto now = m_stats->Record(FrameStats::Stage::Available, arrival);
+            m_availableAt.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+            m_stats->CountOut();
         }
 
         m_textures->MarkTextureFrameAvailable(m_textureId);
@@ -330,62 +1029,89 @@ void TextureCamera::onCameraParameterChanged(
 
 void TextureCamera::EnableSearchQr(bool state)
 {
-    m_enableSearchQr = state;
-    m_counter_qr = 0;
+    if (!state) {
+        m_analyzers.Remove(QrAnalyzer::AnalyzerName);
+        return;
+    }
+
+    // Analyzers may outlive the camera on the workers
+    auto weak = weak_from_this();
+    m_analyzers.Add(std::make_shared<QrAnalyzer>([weak](std::string text) {
+        if (auto self = weak.lock()) {
+            self->m_onChangeQR(self->m_cameraId, text);
+        }
+    }), SearchQrInterval);
+}
+
+std::shared_ptr<FrameStats> TextureCamera::Stats() const
+{
+    return m_stats;
 }
 
-void TextureCamera::SearchQr(std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> frame)
+void TextureCamera::AddAnalyzer(const std::shared_ptr<FrameAnalyzer> &analyzer,
+                                std::chrono::milliseconds interval)
 {
-    int size = frame->chromaStep == 1 ? 15 : 30;
+    m_analyzers.Add(analyzer, interval);
+}
 
-    m_counter_qr += 1;
+void TextureCamera::RemoveAnalyzer(const std::string &name)
+{
+    m_analyzers.Remove(name);
+}
 
-    if (m_counter_qr < 0) {
-        m_counter_qr = 0;
-    }
+void TextureCamera::SetSheetHandler(const SheetHandler &onSheet)
+{
+    std::lock_guard<std::mutex> lock(m_sheetMutex);
+    m_onSheet = onSheet;
+    UpdateSheetAnalyzer();
+}
 
-    if (m_counter_qr % size != 0) {
+void TextureCamera::SetAutoCapture(const AutoCapture::Options &options)
+{
+    std::lock_guard<std::mutex> lock(m_sheetMutex);
+    m_autoCapture.Configure(options);
+    UpdateSheetAnalyzer();
+}
+
+void TextureCamera::UpdateSheetAnalyzer()
+{
+    auto needed = m_onSheet || m_autoCapture.IsEnabled();
+    if (needed == m_isSheetAnalyzer) {
         return;
     }
+    m_isSheetAnalyzer = needed;
 
-    // 720p
-    int width = 1280;
-    int height = 720;
+    if (!needed) {
+        m_analyzers.Remove(SheetAnalyzer::AnalyzerName);
+        return;
+    }
 
-    std::shared_ptr<uint8_t> bits;
+    // Analyzers may outlive the camera on the workers
+    auto weak = weak_from_this();
+    m_analyzers.Add(std::make_shared<SheetAnalyzer>([weak](const SheetAnalyzer::Sheet &sheet) {
+        if (auto self = weak.lock()) {
+            self->OnSheet(sheet);
+        }
+    }), SheetAnalyzer::Interval);
+}
 
-    if (frame->chromaStep == 1 /* I420 */) {
-        auto result = yuv::I420Scale(frame->y,
-                                     frame->cr,
-                                     frame->cb,
-                                     frame->width,
-                                     frame->height,
-                                     width,
-                                     height);
-
-        bits = yuv::I420ToARGB(result.y, result.u, result.v, result.width, result.height);
-    } else if (frame->chromaStep == 2 /* NV12 */) {
-        auto result
-            = yuv::NV12Scale(frame->y, frame->cr, frame->width, frame->height, width, height);
-        bits = yuv::NV12ToARGB(result.y, result.uv, result.width, result.height);
-    }
-
-    if (bits) {
-        auto image = ZXing::ImageView(bits.get(), width, height, ZXing::ImageFormat::RGBX);
-
-        #if PSDK_MAJOR == 5
-            auto hints = ZXing::DecodeHints().setFormats(ZXing::BarcodeFormat::QRCode);
-        #else
-            auto hints = ZXing::DecodeHints().setFormats(ZXing::BarcodeFormat::QR_CODE);
-        #endif
-        
-        auto result = ZXing::ReadBarcode(image, hints);
-        if (result.isValid()) {
-            auto ws = result.text();
-            std::string text(ws.begin(), ws.end());
-            m_onChangeQR(text);
-        } else {
-            m_onChangeQR("");
+void TextureCamera::OnSheet(const SheetAnalyzer::Sheet &sheet)
+{
+    SheetHandler onSheet;
+    {
+        std::lock_guard<std::mutex> lock(m_sheetMutex);
+        onSheet = m_onSheet;
+
+        // The next camera frame is captured, one capture at a time
+        if (m_autoCapture.Check(sheet) && !m_isTakeAuto) {
+            m_autoTimeline = CaptureTimeline(CaptureTimeline::NextId());
+            m_autoTimeline.Mark("detected");
+            m_autoTime = FrameRing::Clock::now();
+            m_isTakeAuto = true;
         }
     }
+
+    if (onSheet) {
+        onSheet(m_cameraId, sheet);
+    }
 }
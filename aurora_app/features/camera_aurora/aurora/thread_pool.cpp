@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    if (threads == 0) {
+        threads = 2;
+    }
+
+    for (size_t index = 0; index < threads; index++) {
+        m_threads.emplace_back([this] { Run(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_condition.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &body)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1) {
+        body(0);
+        return;
+    }
+
+    struct State
+    {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    auto state = std::make_shared<State>();
+
+    auto work = [state, count, &body] {
+        size_t index;
+        while ((index = state->next.fetch_add(1)) < count) {
+            body(index);
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->condition.notify_all();
+            }
+        }
+    };
+
+    auto helpers = std::min(count, m_threads.size() + 1) - 1;
+
+    for (size_t index = 0; index < helpers; index++) {
+        Post(work);
+    }
+
+    // The calling thread takes its share, so a worker may call ParallelFor too
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&] { return state->done.load() == count; });
+}
+
+size_t ThreadPool::Size() const
+{
+    return m_threads.size();
+}
+
+void ThreadPool::Run()
+{
+    while (true) {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+
+            if (m_stop && m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/binarize.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Compares the SSE2 / NEON binarization kernels with the plain loops,
+// on the window the preview overlay uses: the longer side / 32, odd.
+//
+// binarize_benchmark [width] [height] [iterations] [window]
+
+typedef std::chrono::steady_clock Clock;
+
+static double Measure(int iterations, const std::function<void()> &body)
+{
+    body(); // warm up
+
+    auto start = Clock::now();
+
+    for (int index = 0; index < iterations; index++) {
+        body();
+    }
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    auto width = argc > 1 ? atoi(argv[1]) : 1920;
+    auto height = argc > 2 ? atoi(argv[2]) : 1080;
+    auto iterations = argc > 3 ? atoi(argv[3]) : 20;
+    auto window = argc > 4 ? atoi(argv[4]) : (std::max(width, height) / 32) | 1;
+
+    if (width <= 0 || height <= 0 || iterations <= 0 || window <= 0) {
+        fprintf(stderr, "usage: %s [width] [height] [iterations] [window]\n", argv[0]);
+        return 1;
+    }
+
+    // A sheet-like plane with padded rows: paper with a grid, marks, a
+    // lighting gradient and sensor noise
+    auto stride = (width + 63) / 64 * 64;
+
+    std::vector<uint8_t> y(static_cast<size_t>(stride) * height);
+    std::mt19937 random(42);
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            auto line = row % 97 < 3 || col % 131 < 3;
+            auto mark = (row / 97 + col / 131) % 7 == 0;
+            auto value = (line ? 40 : (mark ? 70 : 200)) + col * 40 / width;
+            y[row * stride + col] = static_cast<uint8_t>(value + random() % 16);
+        }
+    }
+
+    printf("plane %dx%d, stride %d, window %d, %d iterations\n", width, height, stride, window, iterations);
+
+    binarize::Histogram serial;
+    auto histogramScalar = Measure(iterations, [&] {
+        serial = binarize::scalar::MakeHistogram(y.data(), stride, width, height);
+    });
+
+    binarize::Histogram fast;
+    auto histogramFast = Measure(iterations, [&] {
+        fast = binarize::MakeHistogram(y.data(), stride, width, height);
+    });
+
+    auto otsu = Measure(iterations, [&] {
+        binarize::Otsu(fast);
+    });
+
+    printf("histogram, scalar %8.2f ms\n", histogramScalar);
+    printf("histogram         %8.2f ms  %.2fx\n", histogramFast, histogramScalar / histogramFast);
+    printf("otsu              %8.3f ms  threshold %d\n", otsu, binarize::Otsu(fast));
+
+    std::vector<uint8_t> expected(static_cast<size_t>(width) * height);
+    auto adaptiveScalar = Measure(iterations, [&] {
+        binarize::scalar::AdaptiveThreshold(y.data(), stride, expected.data(), width, width, height, window, 10);
+    });
+
+    std::vector<uint8_t> actual(static_cast<size_t>(width) * height);
+    auto adaptiveFast = Measure(iterations, [&] {
+        binarize::AdaptiveThreshold(y.data(), stride, actual.data(), width, width, height, window, 10);
+    });
+
+    printf("adaptive, scalar  %8.2f ms\n", adaptiveScalar);
+    printf("adaptive          %8.2f ms  %.2fx\n", adaptiveFast, adaptiveScalar / adaptiveFast);
+
+    if (serial != fast) {
+        fprintf(stderr, "error: histogram differs from the scalar one\n");
+        return 2;
+    }
+    if (expected != actual) {
+        fprintf(stderr, "error: adaptive threshold differs from the scalar one\n");
+        return 2;
+    }
+
+    return 0;
+}
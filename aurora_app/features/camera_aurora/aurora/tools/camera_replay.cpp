@@ -0,0 +1,257 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "fake_camera.h"
+
+#include <camera_aurora/frame_budget.h>
+#include <camera_aurora/texture_camera.h>
+#include <camera_aurora/thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Runs TextureCamera on a replay camera and prints the frame pipeline
+// statistics every second, the ones the app gets on cameraAuroraStats.
+// Exits with 2 if the camera delivered no frame, no preview was
+// converted, the texture was never pulled or, with --stream, no frame
+// was streamed; the ctest of the tools runs it so. With --auto answer
+// sheets are captured as soon as they are framed, stable and sharp.
+//
+// camera_replay [--file frames.yuv] [--format i420|nv12] [--size 1280x720]
+//               [--fps 30] [--seconds 5] [--view 720x1280] [--qr] [--auto]
+//               [--stream 640] [--threads 0]
+
+// Preview conversion time per second, as in the plugin
+constexpr std::chrono::milliseconds PreviewBudget(500);
+
+static bool ParseSize(const char *text, int &width, int &height)
+{
+    return sscanf(text, "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+// Microseconds since the epoch of a capture stage, 0 if not marked
+static int64_t StageTime(const CaptureTimeline &timeline, const std::string &stage)
+{
+    const auto &stages = timeline.Stages();
+    auto it = stages.find(EncodableValue(stage));
+    auto micros = it == stages.end() ? nullptr : std::get_if<int64_t>(&it->second);
+    return micros ? *micros : 0;
+}
+
+// Prints a snapshot, returns the frames converted for the preview
+static uint64_t PrintStats(FrameStats &stats)
+{
+    auto snapshot = stats.Take();
+    auto seconds = snapshot.seconds > 0 ? snapshot.seconds : 1.0;
+
+    printf("in %5.1f fps, out %5.1f fps, allocated %7.1f MB/s, drops",
+           snapshot.framesIn / seconds, snapshot.framesOut / seconds,
+           snapshot.allocated / seconds / (1024 * 1024));
+    for (size_t i = 0; i < FrameStats::Drops; i++) {
+        printf(" %s %llu", FrameStats::DropName(static_cast<FrameStats::Drop>(i)),
+               static_cast<unsigned long long>(snapshot.drops[i]));
+    }
+    printf("\n");
+
+    // Durations in microseconds
+    for (size_t i = 0; i < FrameStats::Stages; i++) {
+        const auto &stage = snapshot.stages[i];
+        if (stage.count == 0) {
+            continue;
+        }
+        printf("  %-10s n %5llu  p50 %7llu  p95 %7llu  p99 %7llu  max %7llu us\n",
+               FrameStats::StageName(static_cast<FrameStats::Stage>(i)),
+               static_cast<unsigned long long>(stage.count),
+               static_cast<unsigned long long>(stage.p50),
+               static_cast<unsigned long long>(stage.p95),
+               static_cast<unsigned long long>(stage.p99),
+               static_cast<unsigned long long>(stage.max));
+    }
+
+    return snapshot.framesOut;
+}
+
+int main(int argc, char *argv[])
+{
+    fake::Options options;
+    auto seconds = 5;
+    auto viewWidth = 720;
+    auto viewHeight = 1280;
+    auto searchQr = false;
+    auto autoCapture = false;
+    auto streamLongEdge = 0;
+    auto threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        auto key = std::string(argv[i]);
+        auto value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto valid = true;
+
+        if (key == "--qr") {
+            searchQr = true;
+            continue;
+        }
+
+        if (key == "--auto") {
+            autoCapture = true;
+            continue;
+        }
+
+        if (!value) {
+            valid = false;
+        } else if (key == "--file") {
+            options.path = value;
+        } else if (key == "--format") {
+            valid = strcmp(value, "i420") == 0 || strcmp(value, "nv12") == 0;
+            options.layout = strcmp(value, "nv12") == 0 ? fake::Layout::NV12 : fake::Layout::I420;
+        } else if (key == "--size") {
+            valid = ParseSize(value, options.width, options.height);
+        } else if (key == "--fps") {
+            options.fps = atoi(value);
+            valid = options.fps > 0;
+        } else if (key == "--seconds") {
+            seconds = atoi(value);
+            valid = seconds > 0;
+        } else if (key == "--view") {
+            valid = ParseSize(value, viewWidth, viewHeight);
+        } else if (key == "--stream") {
+            streamLongEdge = atoi(value);
+            valid = streamLongEdge > 0;
+        } else if (key == "--threads") {
+            threads = atoi(value);
+            valid = threads >= 0;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            fprintf(stderr,
+                    "usage: %s [--file frames.yuv] [--format i420|nv12] [--size WxH] [--fps N]\n"
+                    "       [--seconds N] [--view WxH] [--qr] [--auto] [--stream LONG_EDGE]\n"
+                    "       [--threads N]\n",
+                    argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    auto manager = std::make_shared<fake::CameraManager>(options);
+    fake::CameraManager::Install(manager);
+
+    if (!manager->init()) {
+        fprintf(stderr, "error: %s is missing or not a whole number of %dx%d frames\n",
+                options.path.c_str(), options.width, options.height);
+        return 1;
+    }
+
+    fake::TextureRegistrar registrar;
+    ThreadPool pool(threads);
+    FrameBudget budget(PreviewBudget);
+    // Counted on the camera thread and the pool
+    std::atomic<uint64_t> streamed(0);
+    std::atomic<uint64_t> codes(0);
+    std::atomic<uint64_t> captures(0);
+
+    std::shared_ptr<TextureCamera> camera;
+    camera = std::make_shared<TextureCamera>(
+        &registrar,
+        &pool,
+        &budget,
+        [](int64_t) {},
+        [&codes](int64_t, std::string) { codes++; },
+        [&captures](int64_t, const CaptureTimeline &timeline, std::string image) {
+            auto detected = StageTime(timeline, "detected");
+            auto encoded = StageTime(timeline, "encoded");
+            printf("capture %lld: %zu bytes, %lld us from detection to image\n",
+                   static_cast<long long>(timeline.CaptureId()), image.size(),
+                   static_cast<long long>(encoded - detected));
+            captures++;
+        },
+        [&camera, &streamed](int64_t, const FrameStream::Frame &frame) {
+            // Consumed at once, as a Dart listener that keeps up would
+            streamed++;
+            camera->ReleaseFrame(frame.slot, frame.sequence);
+        });
+
+    camera->Stats()->SetEnabled(true);
+    camera->Register("replay");
+
+    if (searchQr) {
+        camera->EnableSearchQr(true);
+    }
+
+    if (autoCapture) {
+        AutoCapture::Options gate;
+        gate.enabled = true;
+        camera->SetAutoCapture(gate);
+    }
+
+    if (streamLongEdge > 0) {
+        FrameStream::Options stream;
+        stream.longEdge = streamLongEdge;
+        camera->StartImageStream(stream);
+    }
+
+    auto state = camera->StartCapture(viewWidth, viewHeight);
+    auto error = Helper::GetString(state, "error");
+    if (!error.empty()) {
+        fprintf(stderr, "error: %s\n", error.c_str());
+        return 1;
+    }
+
+    printf("%s %dx%d %s at %d fps, view %dx%d, pool of %zu threads\n",
+           options.path.empty() ? "pattern" : options.path.c_str(),
+           options.width, options.height,
+           options.layout == fake::Layout::NV12 ? "NV12" : "I420",
+           options.fps, viewWidth, viewHeight, pool.Size());
+
+    uint64_t previews = 0;
+    for (int second = 0; second < seconds; second++) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        previews += PrintStats(*camera->Stats());
+    }
+
+    camera->StopCapture();
+
+    auto opened = manager->Opened();
+    auto delivered = opened ? opened->Delivered() : 0;
+    auto skipped = opened ? opened->Skipped() : 0;
+
+    camera->Unregister();
+
+    printf("camera %llu frames, %llu skipped; preview %llu; texture %llu marked, %llu pulled",
+           static_cast<unsigned long long>(delivered), static_cast<unsigned long long>(skipped),
+           static_cast<unsigned long long>(previews),
+           static_cast<unsigned long long>(registrar.Marked()),
+           static_cast<unsigned long long>(registrar.Pulled()));
+    if (streamLongEdge > 0) {
+        printf("; streamed %llu", static_cast<unsigned long long>(streamed.load()));
+    }
+    if (searchQr) {
+        printf("; QR changes %llu", static_cast<unsigned long long>(codes.load()));
+    }
+    if (autoCapture) {
+        printf("; auto captures %llu", static_cast<unsigned long long>(captures.load()));
+    }
+    printf("\n");
+
+    auto failed = false;
+    auto check = [&failed](bool passed, const char *what) {
+        if (!passed) {
+            fprintf(stderr, "error: %s\n", what);
+            failed = true;
+        }
+    };
+    check(delivered > 0, "the camera delivered no frame");
+    check(previews > 0, "no frame was converted for the preview");
+    check(registrar.Pulled() > 0, "the texture was never pulled");
+    check(streamLongEdge == 0 || streamed > 0, "no frame was streamed");
+
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,412 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "fake_camera.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace fake {
+
+namespace {
+
+// Frames generated for the pattern, one second at 30 fps
+constexpr int PatternFrames = 30;
+
+std::shared_ptr<fake::CameraManager> g_manager;
+
+class Buffer : public Aurora::StreamCamera::GraphicBuffer
+{
+public:
+    explicit Buffer(const std::shared_ptr<const FrameSource::Frame> &frame)
+        : m_frame(frame)
+    {
+        width = frame->planes.width;
+        height = frame->planes.height;
+    }
+
+    std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame> mapYCbCr() override
+    {
+        // Mapping keeps the frame, as the camera service does
+        return std::shared_ptr<const Aurora::StreamCamera::YCbCrFrame>(m_frame, &m_frame->planes);
+    }
+
+private:
+    std::shared_ptr<const FrameSource::Frame> m_frame;
+};
+
+size_t FrameSize(int width, int height)
+{
+    return static_cast<size_t>(width) * height
+           + 2 * static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+}
+
+// The planes of a packed frame. The plugin reads the first chroma plane
+// of I420 (U) from `cr`, the frames are laid out the way it expects.
+void SetPlanes(FrameSource::Frame &frame, Layout layout, int width, int height)
+{
+    auto &planes = frame.planes;
+    auto chroma = frame.data.data() + static_cast<size_t>(width) * height;
+    auto halfWidth = (width + 1) / 2;
+
+    planes.width = width;
+    planes.height = height;
+    planes.y = frame.data.data();
+    planes.yStride = width;
+
+    if (layout == Layout::I420) {
+        planes.cr = chroma;
+        planes.cb = chroma + static_cast<size_t>(halfWidth) * ((height + 1) / 2);
+        planes.cStride = halfWidth;
+        planes.chromaStep = 1;
+    } else {
+        planes.cr = chroma;
+        planes.cb = chroma + 1;
+        planes.cStride = halfWidth * 2;
+        planes.chromaStep = 2;
+    }
+}
+
+// An answer sheet drifting across the view: paper, grid lines, filled
+// bubbles and a bit of noise, so that every frame differs
+void Generate(FrameSource::Frame &frame, int index, int width, int height)
+{
+    auto y = frame.data.data();
+    auto shift = index * 2;
+    uint32_t noise = 2463534242u + index;
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            auto x = col + shift;
+            auto line = row % 48 < 2 || x % 64 < 2;
+            auto mark = (row / 48 * 7 + x / 64 * 3) % 5 == 0;
+            auto dot = mark && (row % 48 - 24) * (row % 48 - 24) + (x % 64 - 32) * (x % 64 - 32) < 144;
+
+            noise ^= noise << 13;
+            noise ^= noise >> 17;
+            noise ^= noise << 5;
+
+            auto value = line ? 50 : (dot ? 40 : 200);
+            y[static_cast<size_t>(row) * width + col] = static_cast<uint8_t>(value + (noise & 15));
+        }
+    }
+
+    std::fill(frame.data.begin() + static_cast<size_t>(width) * height, frame.data.end(), 128);
+}
+
+} // namespace
+
+std::shared_ptr<FrameSource> FrameSource::Create(const Options &options)
+{
+    if (options.width <= 0 || options.height <= 0) {
+        return nullptr;
+    }
+
+    auto source = std::make_shared<FrameSource>();
+    auto size = FrameSize(options.width, options.height);
+
+    if (options.path.empty()) {
+        for (int index = 0; index < PatternFrames; index++) {
+            auto frame = std::make_shared<Frame>();
+            frame->data.resize(size);
+            Generate(*frame, index, options.width, options.height);
+            SetPlanes(*frame, options.layout, options.width, options.height);
+            source->m_frames.push_back(frame);
+        }
+        return source;
+    }
+
+    std::ifstream file(options.path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return nullptr;
+    }
+
+    auto bytes = static_cast<size_t>(file.tellg());
+    if (bytes == 0 || bytes % size != 0) {
+        return nullptr;
+    }
+
+    file.seekg(0);
+
+    for (size_t index = 0; index < bytes / size; index++) {
+        auto frame = std::make_shared<Frame>();
+        frame->data.resize(size);
+        if (!file.read(reinterpret_cast<char *>(frame->data.data()), size)) {
+            return nullptr;
+        }
+        SetPlanes(*frame, options.layout, options.width, options.height);
+        source->m_frames.push_back(frame);
+    }
+
+    return source;
+}
+
+size_t FrameSource::Size() const
+{
+    return m_frames.size();
+}
+
+std::shared_ptr<const FrameSource::Frame> FrameSource::At(size_t index) const
+{
+    return m_frames[index % m_frames.size()];
+}
+
+Camera::Camera(const std::shared_ptr<FrameSource> &source, int fps)
+    : m_source(source)
+    , m_fps(fps > 0 ? fps : 30)
+{}
+
+Camera::~Camera()
+{
+    stopCapture();
+}
+
+bool Camera::captureStarted() const
+{
+    return m_started;
+}
+
+bool Camera::startCapture(const Aurora::StreamCamera::CameraCapability &capability)
+{
+    if (m_started || !m_source || m_source->Size() == 0) {
+        return false;
+    }
+
+    m_started = true;
+    m_thread = std::thread(&Camera::Run, this, capability.fps > 0 ? capability.fps : m_fps);
+
+    return true;
+}
+
+bool Camera::stopCapture()
+{
+    m_started = false;
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    return true;
+}
+
+void Camera::setListener(Aurora::StreamCamera::CameraListener *listener)
+{
+    m_listener = listener;
+}
+
+uint64_t Camera::Delivered() const
+{
+    return m_delivered;
+}
+
+uint64_t Camera::Skipped() const
+{
+    return m_skipped;
+}
+
+void Camera::Run(int fps)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / fps;
+    auto next = Clock::now();
+    size_t index = 0;
+
+    while (m_started) {
+        std::this_thread::sleep_until(next);
+
+        if (auto listener = m_listener.load()) {
+            listener->onCameraFrame(std::make_shared<Buffer>(m_source->At(index)));
+            m_delivered++;
+        }
+
+        index++;
+        next += period;
+
+        // A slow listener costs frames, the sensor does not wait
+        auto now = Clock::now();
+        while (next < now) {
+            next += period;
+            index++;
+            m_skipped++;
+        }
+    }
+}
+
+CameraManager::CameraManager(const Options &options)
+    : m_options(options)
+{}
+
+void CameraManager::Install(const std::shared_ptr<CameraManager> &manager)
+{
+    g_manager = manager;
+}
+
+bool CameraManager::init()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_source) {
+        m_source = FrameSource::Create(m_options);
+    }
+
+    return m_source != nullptr;
+}
+
+int CameraManager::getNumberOfCameras()
+{
+    return 1;
+}
+
+bool CameraManager::getCameraInfo(int index, Aurora::StreamCamera::CameraInfo &info)
+{
+    if (index != 0) {
+        return false;
+    }
+
+    info.id = "replay";
+    info.name = m_options.path.empty() ? "Pattern" : m_options.path;
+    info.provider = "fake";
+    info.mountAngle = m_options.mountAngle;
+
+    return true;
+}
+
+std::shared_ptr<Aurora::StreamCamera::Camera> CameraManager::openCamera(const std::string &id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (id != "replay" || !m_source) {
+        return nullptr;
+    }
+
+    m_opened = std::make_shared<Camera>(m_source, m_options.fps);
+
+    return m_opened;
+}
+
+bool CameraManager::queryCapabilities(const std::string &id,
+                                      std::vector<Aurora::StreamCamera::CameraCapability> &caps)
+{
+    if (id != "replay") {
+        return false;
+    }
+
+    caps.push_back({m_options.width, m_options.height, m_options.fps});
+
+    return true;
+}
+
+std::shared_ptr<Camera> CameraManager::Opened() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_opened;
+}
+
+TextureRegistrar::TextureRegistrar()
+    : m_thread(&TextureRegistrar::Run, this)
+{}
+
+TextureRegistrar::~TextureRegistrar()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+}
+
+int64_t TextureRegistrar::RegisterTexture(flutter::TextureVariant *texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto id = m_next++;
+    m_textures[id] = texture;
+
+    return id;
+}
+
+bool TextureRegistrar::MarkTextureFrameAvailable(int64_t textureId)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_textures.count(textureId) == 0) {
+            return false;
+        }
+        m_pending.insert(textureId);
+    }
+
+    m_marked++;
+    m_condition.notify_one();
+
+    return true;
+}
+
+bool TextureRegistrar::UnregisterTexture(int64_t textureId)
+{
+    // Waits for a pull in progress: the texture goes with the camera
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.erase(textureId);
+    return m_textures.erase(textureId) > 0;
+}
+
+void TextureRegistrar::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_condition.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+
+        if (m_stop) {
+            return;
+        }
+
+        // Marks that came in meanwhile are one pull, as with the engine
+        auto textureId = *m_pending.begin();
+        m_pending.erase(m_pending.begin());
+
+        auto &pixels = std::get<flutter::PixelBufferTexture>(*m_textures[textureId]);
+        if (auto buffer = pixels.CopyPixelBuffer(0, 0)) {
+            if (buffer->buffer) {
+                m_pulled++;
+            }
+            delete buffer;
+        }
+    }
+}
+
+uint64_t TextureRegistrar::Marked() const
+{
+    return m_marked;
+}
+
+uint64_t TextureRegistrar::Pulled() const
+{
+    return m_pulled;
+}
+
+} // namespace fake
+
+// The pattern camera unless a manager was installed
+std::shared_ptr<Aurora::StreamCamera::CameraManager> StreamCameraManager()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        if (!fake::g_manager) {
+            fake::g_manager = std::make_shared<fake::CameraManager>(fake::Options());
+        }
+    });
+    return fake::g_manager;
+}
+
+namespace aurora {
+
+DisplayOrientation GetOrientation()
+{
+    return DisplayOrientation::Portrait;
+}
+
+} // namespace aurora
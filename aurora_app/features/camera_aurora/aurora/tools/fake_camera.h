@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef CAMERA_AURORA_TOOLS_FAKE_CAMERA_H
+#define CAMERA_AURORA_TOOLS_FAKE_CAMERA_H
+
+#include <flutter/texture_registrar.h>
+#include <streamcamera/streamcamera.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A camera without a device: replays raw I420/NV12 frames from a file,
+// or a generated answer-sheet pattern, at a set FPS through the same
+// streamcamera interfaces TextureCamera uses on the phone.
+namespace fake {
+
+enum class Layout
+{
+    I420,
+    NV12,
+};
+
+struct Options
+{
+    // Raw frames one after another, looped; empty - generated pattern
+    std::string path;
+    Layout layout = Layout::I420;
+    int width = 1280;
+    int height = 720;
+    int fps = 30;
+    int mountAngle = 0;
+};
+
+// Frames of a replay, loaded or generated once, shared by the buffers
+class FrameSource
+{
+public:
+    struct Frame
+    {
+        std::vector<uint8_t> data;
+        Aurora::StreamCamera::YCbCrFrame planes;
+    };
+
+    // Empty on a missing file or a size that is not a whole number of frames
+    static std::shared_ptr<FrameSource> Create(const Options &options);
+
+    size_t Size() const;
+    std::shared_ptr<const Frame> At(size_t index) const;
+
+private:
+    std::vector<std::shared_ptr<Frame>> m_frames;
+};
+
+// Delivers the frames on its own thread, like the camera service does.
+// A tick missed while the listener is busy is skipped, not queued.
+class Camera : public Aurora::StreamCamera::Camera
+{
+public:
+    Camera(const std::shared_ptr<FrameSource> &source, int fps);
+    ~Camera() override;
+
+    bool captureStarted() const override;
+    bool startCapture(const Aurora::StreamCamera::CameraCapability &capability) override;
+    bool stopCapture() override;
+    void setListener(Aurora::StreamCamera::CameraListener *listener) override;
+
+    uint64_t Delivered() const;
+    uint64_t Skipped() const;
+
+private:
+    void Run(int fps);
+
+    std::shared_ptr<FrameSource> m_source;
+    int m_fps;
+    std::thread m_thread;
+    std::atomic<bool> m_started{false};
+    std::atomic<Aurora::StreamCamera::CameraListener *> m_listener{nullptr};
+    std::atomic<uint64_t> m_delivered{0};
+    std::atomic<uint64_t> m_skipped{0};
+};
+
+// One camera, "replay"; Install makes StreamCameraManager() return it
+class CameraManager : public Aurora::StreamCamera::CameraManager
+{
+public:
+    explicit CameraManager(const Options &options);
+
+    static void Install(const std::shared_ptr<CameraManager> &manager);
+
+    bool init() override;
+    int getNumberOfCameras() override;
+    bool getCameraInfo(int index, Aurora::StreamCamera::CameraInfo &info) override;
+    std::shared_ptr<Aurora::StreamCamera::Camera> openCamera(const std::string &id) override;
+    bool queryCapabilities(const std::string &id,
+                           std::vector<Aurora::StreamCamera::CameraCapability> &caps) override;
+
+    // The camera opened last, for its counters
+    std::shared_ptr<Camera> Opened() const;
+
+private:
+    Options m_options;
+    std::shared_ptr<FrameSource> m_source;
+    mutable std::mutex m_mutex;
+    std::shared_ptr<Camera> m_opened;
+};
+
+// Pulls the pixel buffer of every frame marked available on its own
+// "raster" thread, the way the engine does, and counts the frames
+class TextureRegistrar : public flutter::TextureRegistrar
+{
+public:
+    TextureRegistrar();
+    ~TextureRegistrar() override;
+
+    int64_t RegisterTexture(flutter::TextureVariant *texture) override;
+    bool MarkTextureFrameAvailable(int64_t textureId) override;
+    bool UnregisterTexture(int64_t textureId) override;
+
+    uint64_t Marked() const;
+    uint64_t Pulled() const;
+
+private:
+    void Run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::map<int64_t, flutter::TextureVariant *> m_textures;
+    std::set<int64_t> m_pending;
+    int64_t m_next = 1;
+    bool m_stop = false;
+    std::atomic<uint64_t> m_marked{0};
+    std::atomic<uint64_t> m_pulled{0};
+    std::thread m_thread;
+};
+
+} // namespace fake
+
+#endif /* CAMERA_AURORA_TOOLS_FAKE_CAMERA_H */
@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef CAMERA_AURORA_TOOLS_HOST_ENCODABLE_VALUE_H
+#define CAMERA_AURORA_TOOLS_HOST_ENCODABLE_VALUE_H
+
+// Host stand-in of the Flutter standard codec value: the same variant,
+// without the codec
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace flutter {
+
+class EncodableValue;
+
+typedef std::vector<EncodableValue> EncodableList;
+typedef std::map<EncodableValue, EncodableValue> EncodableMap;
+
+typedef std::variant<std::monostate,
+                     bool,
+                     int32_t,
+                     int64_t,
+                     double,
+                     std::string,
+                     std::vector<uint8_t>,
+                     std::vector<int32_t>,
+                     std::vector<int64_t>,
+                     std::vector<double>,
+                     EncodableList,
+                     EncodableMap,
+                     std::vector<float>>
+    EncodableVariant;
+
+class EncodableValue : public EncodableVariant
+{
+public:
+    using EncodableVariant::EncodableVariant;
+    using EncodableVariant::operator=;
+
+    EncodableValue() = default;
+
+    explicit EncodableValue(const char *string)
+        : EncodableVariant(std::string(string))
+    {}
+
+    EncodableValue &operator=(const char *string)
+    {
+        EncodableVariant::operator=(std::string(string));
+        return *this;
+    }
+
+    bool IsNull() const
+    {
+        return std::holds_alternative<std::monostate>(*this);
+    }
+
+    int64_t LongValue() const
+    {
+        if (std::holds_alternative<int32_t>(*this)) {
+            return std::get<int32_t>(*this);
+        }
+        return std::get<int64_t>(*this);
+    }
+
+    friend bool operator<(const EncodableValue &lhs, const EncodableValue &rhs)
+    {
+        return static_cast<const EncodableVariant &>(lhs)
+               < static_cast<const EncodableVariant &>(rhs);
+    }
+};
+
+} // namespace flutter
+
+#endif /* CAMERA_AURORA_TOOLS_HOST_ENCODABLE_VALUE_H */
@@ -0,0 +1,35 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef CAMERA_AURORA_TOOLS_HOST_FLUTTER_AURORA_H
+#define CAMERA_AURORA_TOOLS_HOST_FLUTTER_AURORA_H
+
+// Host stand-in of the embedder API the camera uses
+
+#include <cstddef>
+#include <cstdint>
+
+namespace aurora {
+
+enum class DisplayOrientation
+{
+    Portrait = 0,
+    Landscape = 90,
+    PortraitFlipped = 180,
+    LandscapeFlipped = 270,
+};
+
+// Portrait on the host
+DisplayOrientation GetOrientation();
+
+} // namespace aurora
+
+struct FlutterDesktopPixelBuffer
+{
+    const uint8_t *buffer;
+    size_t width;
+    size_t height;
+};
+
+#endif /* CAMERA_AURORA_TOOLS_HOST_FLUTTER_AURORA_H */
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef CAMERA_AURORA_TOOLS_HOST_TEXTURE_REGISTRAR_H
+#define CAMERA_AURORA_TOOLS_HOST_TEXTURE_REGISTRAR_H
+
+// Host stand-in of the Flutter texture API: pixel buffer textures only
+
+#include <flutter/flutter_aurora.h>
+
+#include <cstdint>
+#include <functional>
+#include <variant>
+
+namespace flutter {
+
+class PixelBufferTexture
+{
+public:
+    typedef std::function<const FlutterDesktopPixelBuffer *(size_t width, size_t height)>
+        CopyBufferCallback;
+
+    explicit PixelBufferTexture(CopyBufferCallback callback)
+        : m_callback(callback)
+    {}
+
+    const FlutterDesktopPixelBuffer *CopyPixelBuffer(size_t width, size_t height) const
+    {
+        return m_callback(width, height);
+    }
+
+private:
+    CopyBufferCallback m_callback;
+};
+
+typedef std::variant<PixelBufferTexture> TextureVariant;
+
+class TextureRegistrar
+{
+public:
+    virtual ~TextureRegistrar() = default;
+    virtual int64_t RegisterTexture(TextureVariant *texture) = 0;
+    virtual bool MarkTextureFrameAvailable(int64_t textureId) = 0;
+    virtual bool UnregisterTexture(int64_t textureId) = 0;
+};
+
+} // namespace flutter
+
+#endif /* CAMERA_AURORA_TOOLS_HOST_TEXTURE_REGISTRAR_H */
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef CAMERA_AURORA_TOOLS_HOST_STREAMCAMERA_H
+#define CAMERA_AURORA_TOOLS_HOST_STREAMCAMERA_H
+
+// Host stand-in of the Aurora streamcamera API: only what the plugin
+// uses, with the same names and shapes. StreamCameraManager() is defined
+// by the replay camera of the tools.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Aurora {
+namespace StreamCamera {
+
+struct CameraInfo
+{
+    std::string id;
+    std::string name;
+    std::string provider;
+    int mountAngle = 0;
+};
+
+struct CameraCapability
+{
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+};
+
+enum class CameraParameter
+{
+    Unknown,
+};
+
+// chromaStep 1 - I420, 2 - NV12 (cr points to the interleaved plane)
+struct YCbCrFrame
+{
+    int width = 0;
+    int height = 0;
+    const uint8_t *y = nullptr;
+    const uint8_t *cr = nullptr;
+    const uint8_t *cb = nullptr;
+    int yStride = 0;
+    int cStride = 0;
+    int chromaStep = 1;
+    uint64_t timestampUs = 0;
+};
+
+class GraphicBuffer
+{
+public:
+    virtual ~GraphicBuffer() = default;
+    virtual std::shared_ptr<const YCbCrFrame> mapYCbCr() = 0;
+
+    int width = 0;
+    int height = 0;
+};
+
+class CameraListener
+{
+public:
+    virtual ~CameraListener() = default;
+    virtual void onCameraError(const std::string &errorDescription) = 0;
+    virtual void onCameraFrame(std::shared_ptr<GraphicBuffer> buffer) = 0;
+    virtual void onCameraParameterChanged(CameraParameter parameter, const std::string &value) = 0;
+};
+
+class Camera
+{
+public:
+    virtual ~Camera() = default;
+    virtual bool captureStarted() const = 0;
+    virtual bool startCapture(const CameraCapability &capability) = 0;
+    virtual bool stopCapture() = 0;
+    virtual void setListener(CameraListener *listener) = 0;
+};
+
+class CameraManager
+{
+public:
+    virtual ~CameraManager() = default;
+    virtual bool init() = 0;
+    virtual int getNumberOfCameras() = 0;
+    virtual bool getCameraInfo(int index, CameraInfo &info) = 0;
+    virtual std::shared_ptr<Camera> openCamera(const std::string &id) = 0;
+    virtual bool queryCapabilities(const std::string &id, std::vector<CameraCapability> &caps) = 0;
+};
+
+} // namespace StreamCamera
+} // namespace Aurora
+
+std::shared_ptr<Aurora::StreamCamera::CameraManager> StreamCameraManager();
+
+#endif /* CAMERA_AURORA_TOOLS_HOST_STREAMCAMERA_H */
@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/jpeg_encoder.h>
+#include <camera_aurora/thread_pool.h>
+
+#include <libyuv/libyuv.h>
+
+#ifdef HAVE_QT
+#include <QBuffer>
+#include <QImage>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Compares the strip encoder, on one core and on the pool, with the
+// QImage::save(..., "JPEG") path the plugin used before.
+//
+// jpeg_benchmark [width] [height] [iterations] [threads]
+
+typedef std::chrono::steady_clock Clock;
+
+static double Measure(int iterations, const std::function<size_t()> &body, size_t &bytes)
+{
+    bytes = body(); // warm up
+
+    auto start = Clock::now();
+
+    for (int index = 0; index < iterations; index++) {
+        bytes = body();
+    }
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    auto width = argc > 1 ? atoi(argv[1]) : 4000;
+    auto height = argc > 2 ? atoi(argv[2]) : 3000;
+    auto iterations = argc > 3 ? atoi(argv[3]) : 5;
+    auto threads = argc > 4 ? atoi(argv[4]) : 0;
+
+    if (width <= 0 || height <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [width] [height] [iterations] [threads]\n", argv[0]);
+        return 1;
+    }
+
+    // A sheet-like frame: paper with a grid, marks and sensor noise
+    auto strideUV = (width + 1) / 2;
+    auto heightUV = (height + 1) / 2;
+
+    std::vector<uint8_t> y(static_cast<size_t>(width) * height);
+    std::vector<uint8_t> u(static_cast<size_t>(strideUV) * heightUV, 128);
+    std::vector<uint8_t> v(static_cast<size_t>(strideUV) * heightUV, 128);
+    std::mt19937 random(42);
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            auto line = row % 97 < 3 || col % 131 < 3;
+            auto mark = (row / 97 + col / 131) % 7 == 0;
+            auto value = line ? 40 : (mark ? 70 : 210);
+            y[row * width + col] = static_cast<uint8_t>(value + random() % 16);
+        }
+    }
+
+    ThreadPool pool(threads > 0 ? threads : 0);
+    jpeg::Planes planes{y.data(), width, u.data(), strideUV, v.data(), strideUV, width, height};
+
+    printf("frame %dx%d (%.1f MP), %d iterations, pool of %zu threads + caller\n",
+           width, height, width * height / 1e6, iterations, pool.Size());
+
+    size_t bytes = 0;
+    double baseline = 0;
+
+#ifdef HAVE_QT
+    baseline = Measure(iterations, [&] {
+        QImage image(QSize(width, height), QImage::Format_RGBA8888);
+        libyuv::I420ToARGB(y.data(), width, u.data(), strideUV, v.data(), strideUV,
+                           image.bits(), width * 4, width, height);
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "JPEG");
+        return static_cast<size_t>(buffer.data().size());
+    }, bytes);
+    printf("QImage::save      %8.1f ms %9zu bytes\n", baseline, bytes);
+#else
+    printf("QImage::save      not built, Qt5 Gui was not found\n");
+#endif
+
+    std::vector<uint8_t> serial;
+    auto single = Measure(iterations, [&] {
+        serial = jpeg::Encode(planes, 75);
+        return serial.size();
+    }, bytes);
+    printf("strips, 1 thread  %8.1f ms %9zu bytes\n", single, bytes);
+
+    std::vector<uint8_t> parallel;
+    auto multi = Measure(iterations, [&] {
+        parallel = jpeg::Encode(planes, 75, &pool);
+        return parallel.size();
+    }, bytes);
+    printf("strips, pool      %8.1f ms %9zu bytes\n", multi, bytes);
+
+    if (baseline > 0) {
+        printf("speedup vs QImage: %.2fx (1 thread), %.2fx (pool)\n", baseline / single, baseline / multi);
+    }
+    printf("speedup of the pool: %.2fx\n", single / multi);
+
+    if (serial != parallel) {
+        fprintf(stderr, "error: parallel output differs from the serial one\n");
+        return 2;
+    }
+
+    return 0;
+}
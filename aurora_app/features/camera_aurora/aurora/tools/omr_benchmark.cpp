@@ -0,0 +1,371 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/omr/grader.h>
+#include <camera_aurora/thread_pool.h>
+
+#include <libyuv/libyuv.h>
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Grades a corpus of sheet photos and checks what is read: every
+// name.jpg of the directory with name.json next to it, the answers
+// marked on the sheet in the format of CORRECT_ANSWER_TEST of
+// aurora_cv.py, [{"question": "1", "correct_answer": "A"}, ...].
+// Photos are graded upright, the EXIF orientation is not applied.
+//
+// Prints the mean time of the grader's stages on one thread, sheets per
+// second on 1 to `threads` threads grading sheets side by side, and how
+// often each question is read right. The stages are the grader's own:
+// binarize thresholds the downscaled photo, corners labels its outlines
+// and fits the table, warp straightens it, grid labels the cells, marks
+// and compare score them.
+//
+// omr_benchmark <directory> [threads] [iterations]
+
+typedef std::chrono::steady_clock Clock;
+
+struct Sheet
+{
+    std::string name;
+    omr::Image luma;
+    omr::AnswerKey truth;
+};
+
+static bool EndsWith(const std::string &text, const std::string &suffix)
+{
+    return text.size() >= suffix.size()
+        && std::equal(suffix.rbegin(), suffix.rend(), text.rbegin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == b;
+           });
+}
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> &data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// The luma plane of a JPEG, libyuv's decoder
+static bool DecodeJpeg(const std::vector<uint8_t> &data, omr::Image &luma)
+{
+    int width = 0;
+    int height = 0;
+    if (libyuv::MJPGSize(data.data(), data.size(), &width, &height) != 0 || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    auto strideUV = (width + 1) / 2;
+    std::vector<uint8_t> u(static_cast<size_t>(strideUV) * ((height + 1) / 2));
+    std::vector<uint8_t> v(u.size());
+
+    luma = omr::Image(width, height);
+    return libyuv::MJPGToI420(data.data(), data.size(), luma.data.data(), width, u.data(), strideUV,
+                              v.data(), strideUV, width, height, width, height) == 0;
+}
+
+// A JSON string at `pos`, the escapes are taken literally but for \" and \\.
+static bool ParseString(const std::string &json, size_t &pos, std::string &value)
+{
+    if (pos >= json.size() || json[pos] != '"') {
+        return false;
+    }
+    value.clear();
+    for (pos++; pos < json.size(); pos++) {
+        if (json[pos] == '"') {
+            pos++;
+            return true;
+        }
+        if (json[pos] == '\\' && pos + 1 < json.size()) {
+            pos++;
+        }
+        value += json[pos];
+    }
+    return false;
+}
+
+static void SkipSpace(const std::string &json, size_t &pos)
+{
+    while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) {
+        pos++;
+    }
+}
+
+// [{"question": "1", "correct_answer": "A"}, ...], other keys are skipped
+// when their values are strings
+static bool ParseTruth(const std::string &json, omr::AnswerKey &truth)
+{
+    size_t pos = 0;
+    SkipSpace(json, pos);
+    if (pos >= json.size() || json[pos++] != '[') {
+        return false;
+    }
+
+    for (;;) {
+        SkipSpace(json, pos);
+        if (pos < json.size() && json[pos] == ']') {
+            return true;
+        }
+        if (pos >= json.size() || json[pos++] != '{') {
+            return false;
+        }
+
+        std::map<std::string, std::string> fields;
+        for (;;) {
+            SkipSpace(json, pos);
+            std::string key;
+            std::string value;
+            if (!ParseString(json, pos, key)) {
+                return false;
+            }
+            SkipSpace(json, pos);
+            if (pos >= json.size() || json[pos++] != ':') {
+                return false;
+            }
+            SkipSpace(json, pos);
+            if (!ParseString(json, pos, value)) {
+                return false;
+            }
+            fields[key] = value;
+
+            SkipSpace(json, pos);
+            if (pos < json.size() && json[pos] == ',') {
+                pos++;
+                continue;
+            }
+            if (pos < json.size() && json[pos] == '}') {
+                pos++;
+                break;
+            }
+            return false;
+        }
+
+        auto question = fields.find("question");
+        auto answer = fields.find("correct_answer");
+        if (question == fields.end() || answer == fields.end()) {
+            return false;
+        }
+        truth[question->second] = answer->second;
+
+        SkipSpace(json, pos);
+        if (pos < json.size() && json[pos] == ',') {
+            pos++;
+        }
+    }
+}
+
+static std::vector<Sheet> LoadSheets(const std::string &directory)
+{
+    std::vector<std::string> names;
+    if (auto dir = opendir(directory.c_str())) {
+        while (auto entry = readdir(dir)) {
+            names.push_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+
+    std::vector<Sheet> sheets;
+    for (const auto &name : names) {
+        std::string stem;
+        if (EndsWith(name, ".jpg")) {
+            stem = name.substr(0, name.size() - 4);
+        } else if (EndsWith(name, ".jpeg")) {
+            stem = name.substr(0, name.size() - 5);
+        } else {
+            continue;
+        }
+
+        Sheet sheet;
+        sheet.name = name;
+
+        std::vector<uint8_t> photo;
+        std::vector<uint8_t> json;
+        if (!ReadFile(directory + "/" + stem + ".json", json)) {
+            fprintf(stderr, "skipped %s: no %s.json\n", name.c_str(), stem.c_str());
+            continue;
+        }
+        if (!ParseTruth(std::string(json.begin(), json.end()), sheet.truth)) {
+            fprintf(stderr, "skipped %s: %s.json is not a list of answers\n", name.c_str(), stem.c_str());
+            continue;
+        }
+        if (!ReadFile(directory + "/" + name, photo) || !DecodeJpeg(photo, sheet.luma)) {
+            fprintf(stderr, "skipped %s: not a JPEG\n", name.c_str());
+            continue;
+        }
+
+        sheets.push_back(std::move(sheet));
+    }
+
+    return sheets;
+}
+
+// Question numbers in numeric order, "2" before "10"
+static bool QuestionLess(const std::string &a, const std::string &b)
+{
+    return a.size() != b.size() ? a.size() < b.size() : a < b;
+}
+
+int main(int argc, char *argv[])
+{
+    auto threads = argc > 2 ? atoi(argv[2]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    auto iterations = argc > 3 ? atoi(argv[3]) : 3;
+
+    if (argc < 2 || threads <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s <directory> [threads] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    auto sheets = LoadSheets(argv[1]);
+    if (sheets.empty()) {
+        fprintf(stderr, "error: no photos with answers in %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%zu sheets, %d iterations\n", sheets.size(), iterations);
+
+    // Accuracy and stage times on one thread, the first pass
+    std::vector<omr::Result> results(sheets.size());
+    for (size_t index = 0; index < sheets.size(); index++) {
+        results[index] = omr::Grade(sheets[index].luma.View(), sheets[index].truth);
+    }
+
+    std::array<int64_t, omr::Result::Stages> micros{};
+    int graded = 0;
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        for (const auto &sheet : sheets) {
+            auto result = omr::Grade(sheet.luma.View(), sheet.truth);
+            if (!result.error.empty()) {
+                continue;
+            }
+            for (size_t stage = 0; stage < omr::Result::Stages; stage++) {
+                micros[stage] += result.micros[stage];
+            }
+            graded++;
+        }
+    }
+
+    printf("\nstage, mean of %d graded sheets\n", graded);
+    int64_t total = 0;
+    for (size_t stage = 0; stage < omr::Result::Stages; stage++) {
+        auto name = omr::Result::StageName(static_cast<omr::Result::Stage>(stage));
+        printf("  %-10s %8.2f ms\n", name, graded > 0 ? micros[stage] / 1000.0 / graded : 0.0);
+        total += micros[stage];
+    }
+    printf("  %-10s %8.2f ms\n", "total", graded > 0 ? total / 1000.0 / graded : 0.0);
+
+    // Whole sheets side by side, as the plugin grades several cameras
+    printf("\nthroughput\n");
+    auto count = sheets.size() * iterations;
+    for (int threadCount = 1; threadCount <= threads; threadCount++) {
+        auto grade = [&](size_t index) {
+            const auto &sheet = sheets[index % sheets.size()];
+            omr::Grade(sheet.luma.View(), sheet.truth);
+        };
+
+        auto start = Clock::now();
+        if (threadCount > 1) {
+            ThreadPool pool(threadCount - 1);
+            pool.ParallelFor(count, grade);
+        } else {
+            for (size_t index = 0; index < count; index++) {
+                grade(index);
+            }
+        }
+        auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        printf("  %2d thread%s %8.2f sheets/s\n", threadCount, threadCount > 1 ? "s" : " ", count / seconds);
+    }
+
+    // Every question of the truth: read right, read as another letter,
+    // or not read, the sheets the table was not found on among them
+    struct Tally
+    {
+        int right = 0;
+        int wrong = 0;
+        int missed = 0;
+    };
+    std::map<std::string, Tally, decltype(&QuestionLess)> tallies(&QuestionLess);
+    int extra = 0;
+
+    printf("\nmistakes\n");
+    auto mistakes = 0;
+    for (size_t index = 0; index < sheets.size(); index++) {
+        const auto &sheet = sheets[index];
+        const auto &result = results[index];
+
+        std::map<std::string, std::string> read;
+        for (const auto &answer : result.answers) {
+            read[answer.question] = answer.answer;
+            if (sheet.truth.count(answer.question) == 0) {
+                printf("  %s: question %s is not on the sheet\n", sheet.name.c_str(), answer.question.c_str());
+                extra++;
+                mistakes++;
+            }
+        }
+        if (!result.error.empty()) {
+            printf("  %s: %s\n", sheet.name.c_str(), result.error.c_str());
+            mistakes++;
+        }
+
+        for (const auto &truth : sheet.truth) {
+            auto &tally = tallies[truth.first];
+            auto answer = read.find(truth.first);
+            if (answer == read.end()) {
+                tally.missed++;
+                if (result.error.empty()) {
+                    printf("  %s: %s not read, is %s\n", sheet.name.c_str(), truth.first.c_str(),
+                           truth.second.c_str());
+                    mistakes++;
+                }
+            } else if (answer->second == truth.second) {
+                tally.right++;
+            } else {
+                tally.wrong++;
+                printf("  %s: %s read %s, is %s\n", sheet.name.c_str(), truth.first.c_str(),
+                       answer->second.c_str(), truth.second.c_str());
+                mistakes++;
+            }
+        }
+    }
+    if (mistakes == 0) {
+        printf("  none\n");
+    }
+
+    printf("\naccuracy\n  question   right   wrong  missed\n");
+    Tally all;
+    for (const auto &tally : tallies) {
+        auto sum = tally.second.right + tally.second.wrong + tally.second.missed;
+        printf("  %-8s %7d %7d %7d  %6.1f%%\n", tally.first.c_str(), tally.second.right, tally.second.wrong,
+               tally.second.missed, 100.0 * tally.second.right / sum);
+        all.right += tally.second.right;
+        all.wrong += tally.second.wrong;
+        all.missed += tally.second.missed;
+    }
+    auto sum = all.right + all.wrong + all.missed;
+    printf("  %-8s %7d %7d %7d  %6.1f%%\n", "all", all.right, all.wrong, all.missed,
+           sum > 0 ? 100.0 * all.right / sum : 0.0);
+    if (extra > 0) {
+        printf("  %d answers to questions that are not on their sheets\n", extra);
+    }
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Open Mobile Platform LLC <community@omp.ru>
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <camera_aurora/trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace trace {
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    int64_t time;
+    int64_t value; // duration of a span, value of a counter
+    char phase;
+};
+
+struct Buffer
+{
+    std::vector<Event> events;
+    std::atomic<uint64_t> head{0};
+    std::atomic<const char *> name{nullptr};
+    int64_t tid = 0;
+    uint64_t session = 0;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<uint64_t> g_session{0};
+std::atomic<size_t> g_capacity{DefaultCapacity};
+
+// Rings allocated by Start, taken by the threads on their first event
+constexpr size_t SpareRings = 16;
+
+std::mutex g_mutex;
+std::vector<std::shared_ptr<Buffer>> g_buffers;
+std::vector<std::shared_ptr<Buffer>> g_spares;
+
+thread_local std::shared_ptr<Buffer> t_buffer;
+
+int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::shared_ptr<Buffer> MakeBuffer(size_t capacity, uint64_t session)
+{
+    auto buffer = std::make_shared<Buffer>();
+    buffer->events.resize(capacity);
+    buffer->session = session;
+    return buffer;
+}
+
+// The ring of the calling thread, once per session: a spare one of
+// Start, allocated only when they are all taken
+Buffer *ThreadBuffer()
+{
+    auto session = g_session.load(std::memory_order_acquire);
+
+    if (!t_buffer || t_buffer->session != session) {
+        std::shared_ptr<Buffer> buffer;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            if (!g_spares.empty() && g_spares.back()->session == session) {
+                buffer = std::move(g_spares.back());
+                g_spares.pop_back();
+            }
+        }
+        if (!buffer) {
+            buffer = MakeBuffer(g_capacity.load(std::memory_order_relaxed), session);
+        }
+
+        buffer->tid = static_cast<int64_t>(syscall(SYS_gettid));
+        if (t_buffer) {
+            buffer->name = t_buffer->name.load(std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_buffers.push_back(buffer);
+        t_buffer = buffer;
+    }
+
+    return t_buffer.get();
+}
+
+void Write(const Event &event)
+{
+    auto buffer = ThreadBuffer();
+    auto index = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[index % buffer->events.size()] = event;
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+std::string Escape(const char *text)
+{
+    std::string result;
+    for (auto c = text; c && *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            result += '\\';
+            result += *c;
+        } else if (static_cast<unsigned char>(*c) >= 0x20) {
+            result += *c;
+        }
+    }
+    return result;
+}
+
+// Chrome trace times are microseconds
+std::string Micros(int64_t nanos)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%" PRId64 ".%03d", nanos / 1000, static_cast<int>(nanos % 1000));
+    return text;
+}
+
+} // namespace
+
+void Start(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    g_capacity = capacity > 0 ? capacity : DefaultCapacity;
+    auto session = g_session.load(std::memory_order_relaxed) + 1;
+
+    // The threads take these on their first event, the recording
+    // threads do not allocate
+    g_buffers.clear();
+    g_buffers.reserve(SpareRings);
+    g_spares.clear();
+    for (size_t index = 0; index < SpareRings; index++) {
+        g_spares.push_back(MakeBuffer(g_capacity, session));
+    }
+
+    g_session.store(session, std::memory_order_release);
+    g_enabled = true;
+}
+
+void Stop()
+{
+    g_enabled = false;
+}
+
+bool IsEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void NameThread(const char *name)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const char *empty = nullptr;
+    ThreadBuffer()->name.compare_exchange_strong(empty, name, std::memory_order_relaxed);
+}
+
+void Counter(const char *name, int64_t value)
+{
+    if (IsEnabled()) {
+        Write(Event{name, Now(), value, 'C'});
+    }
+}
+
+bool Dump(const std::string &path)
+{
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        buffers = g_buffers;
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    auto pid = static_cast<int64_t>(getpid());
+    auto first = true;
+    auto separator = [&first, &file] {
+        file << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (const auto &buffer : buffers) {
+        auto prefix = "\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(buffer->tid);
+
+        if (auto name = buffer->name.load(std::memory_order_relaxed)) {
+            separator();
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\"," << prefix
+                 << ",\"args\":{\"name\":\"" << Escape(name) << "\"}}";
+        }
+
+        // The owner keeps writing: copy, then skip what it overwrote meanwhile
+        auto size = buffer->events.size();
+        auto end = buffer->head.load(std::memory_order_acquire);
+        auto begin = end > size ? end - size : 0;
+
+        std::vector<Event> events;
+        events.reserve(end - begin);
+        for (auto i = begin; i < end; i++) {
+            events.push_back(buffer->events[i % size]);
+        }
+
+        // Event `after` may be half written in slot `after % size`
+        auto after = buffer->head.load(std::memory_order_acquire);
+        auto valid = after + 1 > size ? after + 1 - size : 0;
+
+        for (auto i = std::max(begin, valid); i < end; i++) {
+            const auto &event = events[i - begin];
+
+            separator();
+            file << "{\"name\":\"" << Escape(event.name) << "\",\"ph\":\"" << event.phase << "\","
+                 << prefix << ",\"ts\":" << Micros(event.time);
+
+            if (event.phase == 'X') {
+                file << ",\"dur\":" << Micros(event.value) << "}";
+            } else {
+                file << ",\"args\":{\"value\":" << event.value << "}}";
+            }
+        }
+    }
+
+    file << "\n]}\n";
+    file.close();
+
+    return !file.fail();
+}
+
+Scope::Scope(const char *name)
+    : m_name(name)
+    , m_begin(IsEnabled() ? Now() : 0)
+{}
+
+Scope::~Scope()
+{
+    if (m_begin != 0 && IsEnabled()) {
+        Write(Event{m_name, m_begin, Now() - m_begin, 'X'});
+    }
+}
+
+} // namespace trace
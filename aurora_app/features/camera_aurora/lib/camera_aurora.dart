@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2023 Open Mobile Platform LLC <community@omp.ru>
 // SPDX-License-Identifier: BSD-3-Clause
 import 'dart:async';
+import 'dart:typed_data';
 
 import 'package:camera_aurora/camera_viewfinder.dart';
 import 'package:camera_platform_interface/camera_platform_interface.dart';
@@ -9,6 +10,21 @@ import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 
 import 'camera_aurora_platform_interface.dart';
+import 'camera_data.dart';
+
+export 'camera_data.dart'
+    show
+        CameraOutputFormat,
+        CameraCapture,
+        CameraCaptureResult,
+        CameraCaptureTimings,
+        CameraSheet,
+        CameraSheetGrade,
+        CameraSheetLayout,
+        CameraImageStreamFormat,
+        CameraImageFrame,
+        CameraStats,
+        CameraStageStats;
 
 /// A broadcast stream of events from the Aurora OS device orientation.
 Stream<String>? get cameraSearchQr {
@@ -26,6 +42,208 @@ class CameraAurora extends CameraPlatform {
 
   Stream<String> get onSearchQr => CameraAuroraPlatform.instance.onChangeQr();
 
+  /// QR codes found by the camera [cameraId] only.
+  Stream<String> onSearchQrOf(int cameraId) =>
+      CameraAuroraPlatform.instance.onChangeQr(cameraId: cameraId);
+
+  /// Keep the last [frames] preview frames, [takePicture] then returns
+  /// the sharpest one received before the tap. Zero disables the ring.
+  Future<void> preCapture(int cameraId, int frames) =>
+      CameraAuroraPlatform.instance.preCapture(cameraId, frames);
+
+  /// Set the format of captured images. Document formats are made from
+  /// the Y plane only and box-downscaled so the long edge is [longEdge].
+  Future<void> setOutput(
+    int cameraId,
+    CameraOutputFormat format, {
+    int longEdge = 0,
+    int dpi = 0,
+  }) =>
+      CameraAuroraPlatform.instance
+          .setOutput(cameraId, format, longEdge: longEdge, dpi: dpi);
+
+  /// Full resolution images of progressive captures, listen before
+  /// calling [takePictureProgressive].
+  Stream<CameraCaptureResult> get onCaptureResult =>
+      CameraAuroraPlatform.instance.onCaptureResult();
+
+  /// Like [takePicture], but completes as soon as a thumbnail with the
+  /// long edge [thumbnail] is ready. The full image follows on
+  /// [onCaptureResult] with the same capture id.
+  Future<CameraCapture> takePictureProgressive(
+    int cameraId, {
+    int thumbnail = 320,
+  }) =>
+      CameraAuroraPlatform.instance.takePictureProgressive(cameraId, thumbnail);
+
+  /// Stage times of the capture saved as [fileName], the name of the
+  /// file given by [takePicture]. Null for unknown or older captures.
+  CameraCaptureTimings? captureTimings(String fileName) =>
+      CameraAuroraPlatform.instance.captureTimings(fileName);
+
+  /// Grade the answer sheet in front of the camera on the device, with
+  /// [key] holding the correct letter by question number. With [layout],
+  /// the ID of a registered [CameraSheetLayout], the cells are taken
+  /// from it instead of searched for. Throws a [CameraException] when no
+  /// table or grid is found on the frame.
+  Future<CameraSheetGrade> gradeSheet(
+    int cameraId,
+    Map<String, String> key, {
+    String? layout,
+  }) =>
+      CameraAuroraPlatform.instance.gradeSheet(cameraId, key, layout: layout);
+
+  /// Make [layout] known to [gradeSheet] under its ID, replacing a layout
+  /// of the same ID. Throws a [CameraException] for an invalid layout.
+  Future<void> registerSheetLayout(CameraSheetLayout layout) =>
+      CameraAuroraPlatform.instance.registerSheetLayout(layout);
+
+  /// State changes within [window] reach [CameraViewfinder] as one
+  /// update, 16 ms by default. Zero sends every change.
+  Future<void> setStateWindow(Duration window) =>
+      CameraAuroraPlatform.instance.setStateWindow(window);
+
+  /// Grab [count] full resolution frames [interval] apart and return
+  /// the sharpest, evenly lit one. Only the winner is encoded.
+  Future<XFile> takeBurst(int cameraId, int count, Duration interval) =>
+      CameraAuroraPlatform.instance.takeBurst(cameraId, count, interval);
+
+  /// Frame pipeline statistics of every camera, one event per camera
+  /// each [setStatsInterval]. Nothing is measured while not listened to.
+  Stream<CameraStats> get onStats => CameraAuroraPlatform.instance.onStats();
+
+  /// The answer table on preview frames of [cameraId], about 12 times a
+  /// second, with how still it is. Nothing is searched while not
+  /// listened to.
+  Stream<CameraSheet> onSheet(int cameraId) =>
+      CameraAuroraPlatform.instance.onSheet(cameraId: cameraId);
+
+  /// Capture the answer sheet without a tap: once its corners are at
+  /// least [margin] inside the frame, its [CameraSheet.tilt] is under
+  /// [maxTilt] and its [CameraSheet.jitter] under [maxJitter] for
+  /// [stableFrames] sheet reports in a row, and it is sharper than
+  /// [minSharpness]. The image comes on [onCaptureResult] with the
+  /// `detected` stage in its timings. A sheet is captured once, the
+  /// next capture waits until it leaves the frame.
+  Future<void> setAutoCapture(
+    int cameraId, {
+    bool enabled = true,
+    int stableFrames = 8,
+    double maxTilt = 0.15,
+    double maxJitter = 0.005,
+    double minSharpness = 30,
+    double margin = 0.02,
+  }) =>
+      CameraAuroraPlatform.instance.setAutoCapture(
+        cameraId,
+        enabled: enabled,
+        stableFrames: stableFrames,
+        maxTilt: maxTilt,
+        maxJitter: maxJitter,
+        minSharpness: minSharpness,
+        margin: margin,
+      );
+
+  /// Period of [onStats] events, one second by default.
+  Future<void> setStatsInterval(Duration interval) =>
+      CameraAuroraPlatform.instance.setStatsInterval(interval);
+
+  /// Record spans and counters of the camera, worker and platform
+  /// threads, the last [capacity] events of each thread are kept.
+  Future<void> startTrace({int capacity = 0}) =>
+      CameraAuroraPlatform.instance.startTrace(capacity: capacity);
+
+  Future<void> stopTrace() => CameraAuroraPlatform.instance.stopTrace();
+
+  /// Save the recorded events as Chrome Trace Event JSON, to be opened
+  /// in Perfetto. Returns the file path, a temporary file by default.
+  Future<String> dumpTrace({String? path}) =>
+      CameraAuroraPlatform.instance.dumpTrace(path: path);
+
+  /// Downscaled preview frames read in place from native buffers, at
+  /// most [fps] per second with the long edge [longEdge]. Release each
+  /// frame when done, frames are dropped while all [buffers] are held.
+  Stream<CameraImageFrame> imageStream(
+    int cameraId, {
+    CameraImageStreamFormat format = CameraImageStreamFormat.y,
+    int longEdge = 640,
+    int fps = 15,
+    int buffers = 3,
+  }) {
+    final platform = CameraAuroraPlatform.instance;
+    StreamSubscription<CameraImageFrame>? subscription;
+    var cancelled = false;
+    late final StreamController<CameraImageFrame> controller;
+    controller = StreamController<CameraImageFrame>(
+      onListen: () {
+        subscription = platform.onImageStream(cameraId).listen(
+              (frame) {
+                if (cancelled) {
+                  frame.release();
+                } else {
+                  controller.add(frame);
+                }
+              },
+              onError: controller.addError,
+            );
+        platform.startImageStream(
+          cameraId,
+          format: format,
+          longEdge: longEdge,
+          fps: fps,
+          buffers: buffers,
+        );
+      },
+      // Frames sent before the stop still arrive, they are released
+      // here rather than left holding their buffers
+      onCancel: () async {
+        cancelled = true;
+        await platform.stopImageStream(cameraId);
+        await subscription?.cancel();
+      },
+    );
+    return controller.stream;
+  }
+
+  @override
+  bool supportsImageStreaming() => true;
+
+  @override
+  Stream<CameraImageData> onStreamedImageAvailable(
+    int cameraId, {
+    CameraImageStreamOptions? options,
+  }) {
+    return imageStream(cameraId, format: CameraImageStreamFormat.i420)
+        .asyncMap((frame) async {
+      // The platform interface keeps images, so these planes are copies
+      Uint8List copy(Uint8List plane) => Uint8List.fromList(plane);
+      final data = CameraImageData(
+        format: const CameraImageFormat(ImageFormatGroup.yuv420, raw: 0),
+        width: frame.width,
+        height: frame.height,
+        planes: [
+          CameraImagePlane(
+            bytes: copy(frame.y),
+            bytesPerRow: frame.strideY,
+            bytesPerPixel: 1,
+          ),
+          CameraImagePlane(
+            bytes: copy(frame.u!),
+            bytesPerRow: frame.strideUV,
+            bytesPerPixel: 1,
+          ),
+          CameraImagePlane(
+            bytes: copy(frame.v!),
+            bytesPerRow: frame.strideUV,
+            bytesPerPixel: 1,
+          ),
+        ],
+      );
+      await frame.release();
+      return data;
+    });
+  }
+
   @override
   Future<List<CameraDescription>> availableCameras() =>
       CameraAuroraPlatform.instance.availableCameras();
@@ -49,7 +267,7 @@ class CameraAurora extends CameraPlatform {
 
   @override
   Future<void> dispose(int cameraId) async {
-    await CameraAuroraPlatform.instance.dispose();
+    await CameraAuroraPlatform.instance.dispose(cameraId);
   }
 
   @override
@@ -87,8 +305,9 @@ class CameraAurora extends CameraPlatform {
         if (width.isNaN || height.isNaN || width.isInfinite) {
           return const SizedBox.shrink();
         }
-        CameraAuroraPlatform.instance.resizeFrame(width, height);
+        CameraAuroraPlatform.instance.resizeFrame(cameraId, width, height);
         return CameraViewfinder(
+          cameraId: cameraId,
           width: constraints.maxWidth,
           height: constraints.maxHeight,
         );
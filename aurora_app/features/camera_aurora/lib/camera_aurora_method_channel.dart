@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2023 Open Mobile Platform LLC <community@omp.ru>
 // SPDX-License-Identifier: BSD-3-Clause
 import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
 
 import 'package:camera_platform_interface/camera_platform_interface.dart';
 import 'package:flutter/foundation.dart';
@@ -17,11 +20,29 @@ enum CameraAuroraMethods {
   startCapture,
   stopCapture,
   takePicture,
+  preCapture,
+  takeBurst,
+  setOutput,
+  setStateWindow,
+  startImageStream,
+  stopImageStream,
+  releaseFrame,
+  setStatsInterval,
+  startTrace,
+  stopTrace,
+  dumpTrace,
+  gradeSheet,
+  setAutoCapture,
+  registerSheetLayout,
 }
 
 enum CameraAuroraEvents {
   cameraAuroraStateChanged,
   cameraAuroraQrChanged,
+  cameraAuroraCaptureResults,
+  cameraAuroraImageStream,
+  cameraAuroraStats,
+  cameraAuroraSheet,
 }
 
 /// An implementation of [CameraAuroraPlatform] that uses method channels.
@@ -30,28 +51,247 @@ class MethodChannelCameraAurora extends CameraAuroraPlatform {
   @visibleForTesting
   final methodsChannel = const MethodChannel('camera_aurora');
 
+  final Map<int, CameraOutputFormat> _outputFormats = {};
+
+  // Timings of the latest captures by file name, a few are enough to
+  // hand them over to whoever uploads the file
+  final Map<String, CameraCaptureTimings> _captureTimings = {};
+  static const _captureTimingsLimit = 16;
+
+  // One native subscription per event channel, shared by all the cameras.
+  // State events carry only changed fields: they are applied to the states
+  // kept here, once per listener, which is harmless as a delta is idempotent.
+  final Map<int, Map<dynamic, dynamic>> _states = {};
+
+  late final Stream<int> _stateChanges =
+      EventChannel(CameraAuroraEvents.cameraAuroraStateChanged.name)
+          .receiveBroadcastStream()
+          .map((data) {
+    final cameraId = data['cameraId'] as int;
+    final state = _states.putIfAbsent(cameraId, () => {});
+    (data as Map<dynamic, dynamic>).forEach((key, value) {
+      if (key == 'cameraId') {
+        return;
+      }
+      if (value == null) {
+        state.remove(key);
+      } else {
+        state[key] = value;
+      }
+    });
+    return cameraId;
+  });
+
+  late final Stream<dynamic> _qrChanges =
+      EventChannel(CameraAuroraEvents.cameraAuroraQrChanged.name)
+          .receiveBroadcastStream();
+
+  late final Stream<dynamic> _captureResults =
+      EventChannel(CameraAuroraEvents.cameraAuroraCaptureResults.name)
+          .receiveBroadcastStream();
+
+  late final Stream<dynamic> _imageFrames =
+      EventChannel(CameraAuroraEvents.cameraAuroraImageStream.name)
+          .receiveBroadcastStream();
+
+  late final Stream<CameraStats> _stats =
+      EventChannel(CameraAuroraEvents.cameraAuroraStats.name)
+          .receiveBroadcastStream()
+          .map((data) => CameraStats.fromJson(data));
+
+  // Sheets are searched only while this is listened to
+  late final Stream<dynamic> _sheets =
+      EventChannel(CameraAuroraEvents.cameraAuroraSheet.name)
+          .receiveBroadcastStream();
+
+  @override
+  Stream<CameraState> onChangeState(int cameraId) async* {
+    final state = _states[cameraId];
+    if (state != null) {
+      yield CameraState.fromJson(state);
+    }
+    await for (final id in _stateChanges) {
+      if (id == cameraId) {
+        yield CameraState.fromJson(_states[id] ?? {});
+      }
+    }
+  }
+
+  @override
+  Stream<String> onChangeQr({int? cameraId}) async* {
+    await for (final data in _qrChanges) {
+      if (cameraId == null || data['cameraId'] == cameraId) {
+        yield data['text'].toString();
+      }
+    }
+  }
+
   @override
-  Stream<CameraState> onChangeState() async* {
-    await for (final data
-        in EventChannel(CameraAuroraEvents.cameraAuroraStateChanged.name)
-            .receiveBroadcastStream()) {
-      yield CameraState.fromJson(data);
+  Stream<CameraCaptureResult> onCaptureResult() async* {
+    await for (final data in _captureResults) {
+      final cameraId = data['cameraId'] ?? 0;
+      final captureId = data['captureId'] ?? 0;
+      final image = data['image'] as String?;
+      final timings = CameraCaptureTimings.fromJson(captureId, data['timings'])
+        ..mark('received');
+      yield CameraCaptureResult(
+        cameraId,
+        captureId,
+        image == null || image.isEmpty
+            ? null
+            : _imageToXFile(cameraId, image, timings: timings),
+        timings: timings,
+      );
     }
   }
 
   @override
-  Stream<String> onChangeQr() async* {
-    await for (final data
-        in EventChannel(CameraAuroraEvents.cameraAuroraQrChanged.name)
-            .receiveBroadcastStream()) {
-      yield data.toString();
+  Stream<CameraImageFrame> onImageStream(int cameraId) async* {
+    await for (final data in _imageFrames) {
+      if (data['cameraId'] != cameraId) {
+        continue;
+      }
+      final slot = data['slot'] as int;
+      final sequence = data['sequence'] as int;
+      final height = data['height'] as int;
+      final strideUV = data['strideUV'] as int;
+      final isI420 = data['format'] == CameraImageStreamFormat.i420.name;
+      // View of the native slot, valid until the frame is released
+      final bytes = Pointer<Uint8>.fromAddress(data['address'] as int)
+          .asTypedList(data['size'] as int);
+      Uint8List? plane(int offset) => isI420
+          ? Uint8List.sublistView(
+              bytes, offset, offset + strideUV * ((height + 1) ~/ 2))
+          : null;
+      yield CameraImageFrame(
+        cameraId: cameraId,
+        slot: slot,
+        sequence: sequence,
+        format: isI420
+            ? CameraImageStreamFormat.i420
+            : CameraImageStreamFormat.y,
+        width: data['width'],
+        height: height,
+        strideY: data['strideY'],
+        strideUV: strideUV,
+        y: Uint8List.sublistView(bytes, 0, data['strideY'] * height),
+        u: plane(data['offsetU']),
+        v: plane(data['offsetV']),
+        dropped: data['dropped'],
+        onRelease: () => releaseFrame(cameraId, slot, sequence),
+      );
+    }
+  }
+
+  @override
+  Future<void> startImageStream(
+    int cameraId, {
+    CameraImageStreamFormat format = CameraImageStreamFormat.y,
+    int longEdge = 640,
+    int fps = 15,
+    int buffers = 3,
+  }) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.startImageStream.name, {
+      'cameraId': cameraId,
+      'format': format.name,
+      'longEdge': longEdge,
+      'fps': fps,
+      'buffers': buffers,
+    });
+  }
+
+  @override
+  Future<void> stopImageStream(int cameraId) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.stopImageStream.name, {
+      'cameraId': cameraId,
+    });
+  }
+
+  @override
+  Future<void> releaseFrame(int cameraId, int slot, int sequence) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.releaseFrame.name, {
+      'cameraId': cameraId,
+      'slot': slot,
+      'sequence': sequence,
+    });
+  }
+
+  @override
+  Stream<CameraStats> onStats() => _stats;
+
+  @override
+  Stream<CameraSheet> onSheet({int? cameraId}) async* {
+    await for (final data in _sheets) {
+      if (cameraId == null || data['cameraId'] == cameraId) {
+        yield CameraSheet.fromJson(data);
+      }
     }
   }
 
   @override
-  Future<void> resizeFrame(double width, double height) async {
+  Future<void> setAutoCapture(
+    int cameraId, {
+    required bool enabled,
+    int stableFrames = 8,
+    double maxTilt = 0.15,
+    double maxJitter = 0.005,
+    double minSharpness = 30,
+    double margin = 0.02,
+  }) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.setAutoCapture.name, {
+      'cameraId': cameraId,
+      'enabled': enabled,
+      'stableFrames': stableFrames,
+      'maxTilt': maxTilt,
+      'maxJitter': maxJitter,
+      'minSharpness': minSharpness,
+      'margin': margin,
+    });
+  }
+
+  @override
+  Future<void> setStatsInterval(Duration interval) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.setStatsInterval.name, {
+      'interval': interval.inMilliseconds,
+    });
+  }
+
+  @override
+  Future<void> startTrace({int capacity = 0}) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.startTrace.name, {
+      'capacity': capacity,
+    });
+  }
+
+  @override
+  Future<void> stopTrace() async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.stopTrace.name);
+  }
+
+  @override
+  Future<String> dumpTrace({String? path}) async {
+    final file = await methodsChannel
+        .invokeMethod<String?>(CameraAuroraMethods.dumpTrace.name, {
+      'path': path ?? '${Directory.systemTemp.path}/camera_aurora_trace.json',
+    });
+    if (file == null || file.isEmpty) {
+      throw CameraException('trace', 'Failed to write the trace!');
+    }
+    return file;
+  }
+
+  @override
+  Future<void> resizeFrame(int cameraId, double width, double height) async {
     await methodsChannel
         .invokeMethod<Object?>(CameraAuroraMethods.resizeFrame.name, {
+      'cameraId': cameraId,
       'width': width.round(),
       'height': height.isInfinite ? -1 : height.round(),
     });
@@ -95,40 +335,187 @@ class MethodChannelCameraAurora extends CameraAuroraPlatform {
   }
 
   @override
-  Future<void> startCapture(double width, double height) async {
+  Future<void> startCapture(int cameraId, double width, double height) async {
     await methodsChannel
         .invokeMethod<Object?>(CameraAuroraMethods.startCapture.name, {
+      'cameraId': cameraId,
       'width': width.round(),
       'height': height.isInfinite ? -1 : height.round(),
     });
   }
 
   @override
-  Future<void> stopCapture() async {
+  Future<void> stopCapture(int cameraId) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.stopCapture.name, {
+      'cameraId': cameraId,
+    });
+  }
+
+  @override
+  Future<void> dispose(int cameraId) async {
     await methodsChannel
-        .invokeMethod<Object?>(CameraAuroraMethods.stopCapture.name, {});
+        .invokeMethod<Object?>(CameraAuroraMethods.dispose.name, {
+      'cameraId': cameraId,
+    });
+    _outputFormats.remove(cameraId);
+  }
+
+  @override
+  Future<void> preCapture(int cameraId, int frames) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.preCapture.name, {
+      'cameraId': cameraId,
+      'frames': frames,
+    });
   }
 
   @override
-  Future<void> dispose() async {
+  Future<void> setOutput(
+    int cameraId,
+    CameraOutputFormat format, {
+    int longEdge = 0,
+    int dpi = 0,
+  }) async {
     await methodsChannel
-        .invokeMethod<Object?>(CameraAuroraMethods.dispose.name);
+        .invokeMethod<Object?>(CameraAuroraMethods.setOutput.name, {
+      'cameraId': cameraId,
+      'format': format.name,
+      'longEdge': longEdge,
+      'dpi': dpi,
+    });
+    _outputFormats[cameraId] = format;
+  }
+
+  @override
+  Future<void> setStateWindow(Duration window) async {
+    await methodsChannel
+        .invokeMethod<Object?>(CameraAuroraMethods.setStateWindow.name, {
+      'window': window.inMilliseconds,
+    });
   }
 
   @override
   Future<XFile> takePicture(int cameraId) async {
-    final image = await methodsChannel.invokeMethod<String?>(
+    final data = await methodsChannel.invokeMethod<Map<dynamic, dynamic>?>(
       CameraAuroraMethods.takePicture.name,
       {'cameraId': cameraId},
     );
-    if (image!.isEmpty) {
+    final timings =
+        CameraCaptureTimings.fromJson(data?['captureId'] ?? 0, data?['timings'])
+          ..mark('received');
+    return _imageToXFile(cameraId, data?['image'], timings: timings);
+  }
+
+  @override
+  Future<CameraSheetGrade> gradeSheet(
+    int cameraId,
+    Map<String, String> key, {
+    String? layout,
+  }) async {
+    final data = await methodsChannel.invokeMethod<Map<dynamic, dynamic>?>(
+      CameraAuroraMethods.gradeSheet.name,
+      {
+        'cameraId': cameraId,
+        'key': key,
+        'layout': layout ?? '',
+      },
+    );
+    if (data == null) {
+      throw CameraException('grade', 'Camera not found!');
+    }
+    final error = data['error'] as String? ?? '';
+    if (error.isNotEmpty) {
+      throw CameraException('grade', error);
+    }
+    return CameraSheetGrade.fromJson(data);
+  }
+
+  @override
+  Future<void> registerSheetLayout(CameraSheetLayout layout) async {
+    final error = await methodsChannel.invokeMethod<String?>(
+      CameraAuroraMethods.registerSheetLayout.name,
+      layout.toMap(),
+    );
+    if (error != null && error.isNotEmpty) {
+      throw CameraException('layout', error);
+    }
+  }
+
+  @override
+  CameraCaptureTimings? captureTimings(String fileName) =>
+      _captureTimings[fileName];
+
+  @override
+  Future<CameraCapture> takePictureProgressive(
+    int cameraId,
+    int thumbnail,
+  ) async {
+    final data = await methodsChannel.invokeMethod<Map<dynamic, dynamic>?>(
+      CameraAuroraMethods.takePicture.name,
+      {
+        'cameraId': cameraId,
+        'thumbnail': thumbnail,
+      },
+    );
+    final image = data?['thumbnail'] as String?;
+    if (image == null || image.isEmpty) {
+      throw CameraException('nv12', 'Empty image data!');
+    }
+    final bytes = base64Decode(image);
+    final captureId = data!['captureId'];
+    return CameraCapture(
+      captureId,
+      XFile.fromData(
+        bytes,
+        name: 'thumbnail.jpg',
+        mimeType: 'image/jpeg',
+        length: bytes.length,
+      ),
+      timings: CameraCaptureTimings.fromJson(captureId, data['timings'])
+        ..mark('received'),
+    );
+  }
+
+  @override
+  Future<XFile> takeBurst(int cameraId, int count, Duration interval) async {
+    final image = await methodsChannel.invokeMethod<String?>(
+      CameraAuroraMethods.takeBurst.name,
+      {
+        'cameraId': cameraId,
+        'count': count,
+        'interval': interval.inMilliseconds,
+      },
+    );
+    return _imageToXFile(cameraId, image);
+  }
+
+  XFile _imageToXFile(
+    int cameraId,
+    String? image, {
+    CameraCaptureTimings? timings,
+  }) {
+    if (image == null || image.isEmpty) {
       throw CameraException('nv12', 'Empty image data!');
     }
     final bytes = base64Decode(image);
+    final isPng = _outputFormats[cameraId] == CameraOutputFormat.binary;
+    // The capture ID in the name follows the file to the upload
+    final base = timings == null || timings.captureId == 0
+        ? 'temp'
+        : 'capture_${timings.captureId}';
+    final name = isPng ? '$base.png' : '$base.jpg';
+    if (timings != null && timings.captureId != 0) {
+      _captureTimings.remove(name);
+      _captureTimings[name] = timings;
+      while (_captureTimings.length > _captureTimingsLimit) {
+        _captureTimings.remove(_captureTimings.keys.first);
+      }
+    }
     return XFile.fromData(
       bytes,
-      name: 'temp.jpg',
-      mimeType: 'image/jpeg',
+      name: name,
+      mimeType: isPng ? 'image/png' : 'image/jpeg',
       length: bytes.length,
     );
   }
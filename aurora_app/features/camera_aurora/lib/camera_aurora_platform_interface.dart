@@ -27,15 +27,19 @@ abstract class CameraAuroraPlatform extends PlatformInterface {
     _instance = instance;
   }
 
-  Stream<CameraState> onChangeState() {
+  Stream<CameraState> onChangeState(int cameraId) {
     throw UnimplementedError('onChangeState() has not been implemented.');
   }
 
-  Stream<String> onChangeQr() {
+  Stream<String> onChangeQr({int? cameraId}) {
     throw UnimplementedError('onChangeQr() has not been implemented.');
   }
 
-  Future<void> resizeFrame(double width, double height) {
+  Stream<CameraCaptureResult> onCaptureResult() {
+    throw UnimplementedError('onCaptureResult() has not been implemented.');
+  }
+
+  Future<void> resizeFrame(int cameraId, double width, double height) {
     throw UnimplementedError('resizeFrame() has not been implemented.');
   }
 
@@ -43,11 +47,11 @@ abstract class CameraAuroraPlatform extends PlatformInterface {
     throw UnimplementedError('availableCameras() has not been implemented.');
   }
 
-  Future<void> startCapture(double width, double height) {
+  Future<void> startCapture(int cameraId, double width, double height) {
     throw UnimplementedError('startCapture() has not been implemented.');
   }
 
-  Future<void> stopCapture() {
+  Future<void> stopCapture(int cameraId) {
     throw UnimplementedError('stopCapture() has not been implemented.');
   }
 
@@ -55,11 +59,112 @@ abstract class CameraAuroraPlatform extends PlatformInterface {
     throw UnimplementedError('createCamera() has not been implemented.');
   }
 
-  Future<void> dispose() {
+  Future<void> dispose(int cameraId) {
     throw UnimplementedError('dispose() has not been implemented.');
   }
 
+  Future<void> preCapture(int cameraId, int frames) {
+    throw UnimplementedError('preCapture() has not been implemented.');
+  }
+
+  Future<void> setOutput(
+    int cameraId,
+    CameraOutputFormat format, {
+    int longEdge = 0,
+    int dpi = 0,
+  }) {
+    throw UnimplementedError('setOutput() has not been implemented.');
+  }
+
+  Future<void> setStateWindow(Duration window) {
+    throw UnimplementedError('setStateWindow() has not been implemented.');
+  }
+
   Future<XFile> takePicture(int cameraId) {
     throw UnimplementedError('takePicture() has not been implemented.');
   }
+
+  Future<CameraCapture> takePictureProgressive(int cameraId, int thumbnail) {
+    throw UnimplementedError(
+        'takePictureProgressive() has not been implemented.');
+  }
+
+  Future<CameraSheetGrade> gradeSheet(
+    int cameraId,
+    Map<String, String> key, {
+    String? layout,
+  }) {
+    throw UnimplementedError('gradeSheet() has not been implemented.');
+  }
+
+  Future<void> registerSheetLayout(CameraSheetLayout layout) {
+    throw UnimplementedError(
+        'registerSheetLayout() has not been implemented.');
+  }
+
+  Future<XFile> takeBurst(int cameraId, int count, Duration interval) {
+    throw UnimplementedError('takeBurst() has not been implemented.');
+  }
+
+  Stream<CameraImageFrame> onImageStream(int cameraId) {
+    throw UnimplementedError('onImageStream() has not been implemented.');
+  }
+
+  Future<void> startImageStream(
+    int cameraId, {
+    CameraImageStreamFormat format = CameraImageStreamFormat.y,
+    int longEdge = 640,
+    int fps = 15,
+    int buffers = 3,
+  }) {
+    throw UnimplementedError('startImageStream() has not been implemented.');
+  }
+
+  Future<void> stopImageStream(int cameraId) {
+    throw UnimplementedError('stopImageStream() has not been implemented.');
+  }
+
+  Future<void> releaseFrame(int cameraId, int slot, int sequence) {
+    throw UnimplementedError('releaseFrame() has not been implemented.');
+  }
+
+  Stream<CameraStats> onStats() {
+    throw UnimplementedError('onStats() has not been implemented.');
+  }
+
+  Stream<CameraSheet> onSheet({int? cameraId}) {
+    throw UnimplementedError('onSheet() has not been implemented.');
+  }
+
+  Future<void> setAutoCapture(
+    int cameraId, {
+    required bool enabled,
+    int stableFrames = 8,
+    double maxTilt = 0.15,
+    double maxJitter = 0.005,
+    double minSharpness = 30,
+    double margin = 0.02,
+  }) {
+    throw UnimplementedError('setAutoCapture() has not been implemented.');
+  }
+
+  Future<void> setStatsInterval(Duration interval) {
+    throw UnimplementedError('setStatsInterval() has not been implemented.');
+  }
+
+  Future<void> startTrace({int capacity = 0}) {
+    throw UnimplementedError('startTrace() has not been implemented.');
+  }
+
+  Future<void> stopTrace() {
+    throw UnimplementedError('stopTrace() has not been implemented.');
+  }
+
+  Future<String> dumpTrace({String? path}) {
+    throw UnimplementedError('dumpTrace() has not been implemented.');
+  }
+
+  CameraCaptureTimings? captureTimings(String fileName) {
+    throw UnimplementedError('captureTimings() has not been implemented.');
+  }
 }
@@ -1,5 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2023 Open Mobile Platform LLC <community@omp.ru>
 // SPDX-License-Identifier: BSD-3-Clause
+import 'dart:typed_data';
+import 'dart:ui' show Offset;
+
+import 'package:camera_platform_interface/camera_platform_interface.dart';
+
 enum OrientationEvent {
   undefined,
   portrait,
@@ -8,6 +13,314 @@ enum OrientationEvent {
   landscapeFlipped,
 }
 
+/// Format of the captured image.
+enum CameraOutputFormat {
+  /// Colour JPEG.
+  jpeg,
+
+  /// 8-bit grayscale JPEG made from the Y plane.
+  gray,
+
+  /// 1-bit adaptively binarised PNG made from the Y plane.
+  binary,
+}
+
+/// Wall clock times of the stages of one capture: `requested`, `frame`,
+/// `thumbnail`, `encoded` and `delivered` natively, `received` in Dart.
+/// Apps add their own stages to follow the image further.
+class CameraCaptureTimings {
+  CameraCaptureTimings(this.captureId, [Map<String, DateTime>? stages])
+      : stages = stages ?? {};
+
+  CameraCaptureTimings.fromJson(this.captureId, Map<dynamic, dynamic>? json)
+      : stages = (json ?? {}).map((key, value) => MapEntry(
+            key.toString(), DateTime.fromMicrosecondsSinceEpoch(value)));
+
+  final int captureId;
+  final Map<String, DateTime> stages;
+
+  void mark(String stage) => stages[stage] = DateTime.now();
+
+  /// Microseconds since the epoch by stage.
+  Map<String, int> toJson() =>
+      stages.map((key, value) => MapEntry(key, value.microsecondsSinceEpoch));
+}
+
+/// Quick answer of a progressive capture.
+class CameraCapture {
+  const CameraCapture(this.captureId, this.thumbnail, {this.timings});
+
+  /// Identifies the [CameraCaptureResult] carrying the full image.
+  final int captureId;
+
+  /// Small colour JPEG of the captured frame.
+  final XFile thumbnail;
+
+  final CameraCaptureTimings? timings;
+}
+
+/// Full resolution image of a progressive capture.
+class CameraCaptureResult {
+  const CameraCaptureResult(
+    this.cameraId,
+    this.captureId,
+    this.image, {
+    this.timings,
+  });
+
+  final int cameraId;
+  final int captureId;
+
+  /// Encoded in the format set by `setOutput`, null if encoding failed.
+  final XFile? image;
+
+  final CameraCaptureTimings? timings;
+}
+
+/// Answer sheet graded on the device, the same as the server's `/upload`.
+class CameraSheetGrade {
+  CameraSheetGrade.fromJson(Map<dynamic, dynamic> json)
+      : answers = (json['answers'] as List<dynamic>? ?? [])
+            .map((answer) => {
+                  for (final key in const [
+                    'question',
+                    'answer',
+                    'correct-answer',
+                  ])
+                    key: (answer as Map)[key]?.toString() ?? '',
+                })
+            .toList(),
+        confidence = (json['answers'] as List<dynamic>? ?? [])
+            .map((answer) => (((answer as Map)['confidence'] ?? 0) as num)
+                .toDouble())
+            .toList(),
+        correct = json['total-correct-answers'] ?? 0,
+        incorrect = json['total-incorrect-answers'] ?? 0,
+        timings = Map<String, int>.from(json['timings'] ?? {});
+
+  /// `question`, `answer` and `correct-answer` of every marked cell.
+  final List<Map<String, String>> answers;
+
+  /// How sure the grader is of each answer, 0 to 1, in the order of
+  /// [answers]. Low for a mark much fainter than the others on the sheet.
+  final List<double> confidence;
+
+  final int correct;
+  final int incorrect;
+
+  /// Microseconds spent in each stage of the grading.
+  final Map<String, int> timings;
+
+  /// The `/upload` response body.
+  Map<String, dynamic> toJson() => {
+        'answers': answers,
+        'total-correct-answers': correct,
+        'total-incorrect-answers': incorrect,
+      };
+}
+
+/// Printed answer table graded without searching for its grid.
+///
+/// Lengths are shares of the straightened table: the letter row on top
+/// is [header] high, the question number column on the left is
+/// [labels] wide, and the rest holds [questions] x [options] equal
+/// cells. [inset] of a cell is left out on every side for the lines.
+/// [fiducials] are centers of dark square markers [fiducialSize] wide;
+/// a sheet without them at those places is not graded.
+class CameraSheetLayout {
+  const CameraSheetLayout({
+    required this.id,
+    required this.questions,
+    required this.options,
+    this.width = 1000,
+    this.height = 1400,
+    this.header = 0,
+    this.labels = 0,
+    this.inset = 0.15,
+    this.fiducials = const [],
+    this.fiducialSize = 0,
+  });
+
+  final String id;
+  final int questions;
+  final int options;
+
+  /// Pixels of the straightened table.
+  final int width;
+  final int height;
+
+  final double header;
+  final double labels;
+  final double inset;
+  final List<Offset> fiducials;
+  final double fiducialSize;
+
+  Map<String, dynamic> toMap() => {
+        'id': id,
+        'questions': questions,
+        'options': options,
+        'width': width,
+        'height': height,
+        'header': header,
+        'labels': labels,
+        'inset': inset,
+        'fiducials': [
+          for (final fiducial in fiducials) ...[fiducial.dx, fiducial.dy],
+        ],
+        'fiducialSize': fiducialSize,
+      };
+}
+
+/// Answer table found on a preview frame.
+///
+/// Corners go clockwise from the top left as shares of the frame width
+/// and height, in the orientation of the preview texture: drawn inside
+/// the same rotation as the texture, they outline the sheet. Empty when
+/// the table is lost.
+class CameraSheet {
+  CameraSheet.fromJson(Map<dynamic, dynamic> json)
+      : cameraId = json['cameraId'] ?? 0,
+        sequence = json['sequence'] ?? 0,
+        corners = _corners(json['corners'] as List<dynamic>? ?? []),
+        jitter = ((json['jitter'] ?? 0) as num).toDouble(),
+        stability = ((json['stability'] ?? 0) as num).toDouble(),
+        tilt = ((json['tilt'] ?? 0) as num).toDouble(),
+        sharpness = ((json['sharpness'] ?? 0) as num).toDouble();
+
+  final int cameraId;
+  final int sequence;
+  final List<Offset> corners;
+
+  /// RMS movement of the corners over the last frames, share of the frame.
+  final double jitter;
+
+  /// 1 when the table stood still in all of the last frames, 0 when it
+  /// moves or was just found.
+  final double stability;
+
+  /// How much shorter the shorter of two opposite edges is, 0 when the
+  /// sheet is shot straight on.
+  final double tilt;
+
+  /// Focus of the sheet on the preview frame, bigger is sharper.
+  final double sharpness;
+
+  bool get isFound => corners.length == 4;
+
+  static List<Offset> _corners(List<dynamic> xy) => [
+        for (var i = 0; i + 1 < xy.length; i += 2)
+          Offset((xy[i] as num).toDouble(), (xy[i + 1] as num).toDouble()),
+      ];
+}
+
+/// Pixel layout of the image stream.
+enum CameraImageStreamFormat {
+  /// Luma plane only.
+  y,
+
+  /// Planar Y, U and V, chroma at half resolution.
+  i420,
+}
+
+/// Downscaled preview frame of the image stream.
+///
+/// The planes are views of a native buffer owned by the camera, no pixels
+/// are copied. Call [release] once done: the camera drops frames while all
+/// of its buffers are held, and the views must not be read after it.
+class CameraImageFrame {
+  CameraImageFrame({
+    required this.cameraId,
+    required this.slot,
+    required this.sequence,
+    required this.format,
+    required this.width,
+    required this.height,
+    required this.strideY,
+    required this.strideUV,
+    required this.y,
+    required this.u,
+    required this.v,
+    required this.dropped,
+    required Future<void> Function() onRelease,
+  }) : _onRelease = onRelease;
+
+  final int cameraId;
+  final int slot;
+  final int sequence;
+  final CameraImageStreamFormat format;
+  final int width;
+  final int height;
+  final int strideY;
+  final int strideUV;
+  final Uint8List y;
+
+  /// Null for [CameraImageStreamFormat.y].
+  final Uint8List? u;
+  final Uint8List? v;
+
+  /// Frames dropped so far because no buffer was free.
+  final int dropped;
+
+  final Future<void> Function() _onRelease;
+  bool _released = false;
+
+  /// Hand the buffer back to the camera.
+  Future<void> release() async {
+    if (_released) {
+      return;
+    }
+    _released = true;
+    await _onRelease();
+  }
+}
+
+/// Durations of one pipeline stage in a statistics window, microseconds.
+class CameraStageStats {
+  CameraStageStats.fromJson(Map<dynamic, dynamic> json)
+      : count = json['count'] ?? 0,
+        p50 = Duration(microseconds: json['p50'] ?? 0),
+        p95 = Duration(microseconds: json['p95'] ?? 0),
+        p99 = Duration(microseconds: json['p99'] ?? 0),
+        max = Duration(microseconds: json['max'] ?? 0);
+
+  final int count;
+  final Duration p50;
+  final Duration p95;
+  final Duration p99;
+  final Duration max;
+}
+
+/// Frame pipeline statistics of a camera since the previous event.
+///
+/// Stages are `map`, `scale`, `convert`, `analyze`, `available` (buffer
+/// arrival to texture update) and `pull` (texture update to the engine
+/// reading it). Drops are counted by reason: `decimate`, `budget`,
+/// `capture` and `stream`.
+class CameraStats {
+  CameraStats.fromJson(Map<dynamic, dynamic> json)
+      : cameraId = json['cameraId'] ?? 0,
+        window = Duration(
+            microseconds: (((json['seconds'] ?? 0) as num) * 1e6).round()),
+        fpsIn = ((json['fpsIn'] ?? 0) as num).toDouble(),
+        fpsOut = ((json['fpsOut'] ?? 0) as num).toDouble(),
+        allocated = json['allocated'] ?? 0,
+        drops = Map<String, int>.from(json['drops'] ?? {}),
+        stages = (json['stages'] as Map<dynamic, dynamic>? ?? {}).map(
+          (key, value) =>
+              MapEntry(key.toString(), CameraStageStats.fromJson(value)),
+        );
+
+  final int cameraId;
+  final Duration window;
+  final double fpsIn;
+  final double fpsOut;
+
+  /// Bytes allocated for preview frames in the window.
+  final int allocated;
+  final Map<String, int> drops;
+  final Map<String, CameraStageStats> stages;
+}
+
 class CameraState {
   CameraState.fromJson(Map<dynamic, dynamic> json)
       : id = json['id'] ?? "",
@@ -1,5 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2023 Open Mobile Platform LLC <community@omp.ru>
 // SPDX-License-Identifier: BSD-3-Clause
+import 'dart:async';
+
 import 'package:camera_aurora/camera_aurora_platform_interface.dart';
 import 'package:flutter/material.dart';
 
@@ -8,10 +10,12 @@ import 'camera_data.dart';
 class CameraViewfinder extends StatefulWidget {
   const CameraViewfinder({
     super.key,
+    required this.cameraId,
     required this.width,
     required this.height,
   });
 
+  final int cameraId;
   final double width;
   final double height;
 
@@ -21,12 +25,16 @@ class CameraViewfinder extends StatefulWidget {
 
 class _CameraViewfinderState extends State<CameraViewfinder> {
   CameraState _cameraState = CameraState.fromJson({});
+  StreamSubscription<CameraState>? _subscription;
 
   @override
   initState() {
     super.initState();
-    CameraAuroraPlatform.instance.startCapture(widget.width, widget.height);
-    CameraAuroraPlatform.instance.onChangeState().listen((event) {
+    CameraAuroraPlatform.instance
+        .startCapture(widget.cameraId, widget.width, widget.height);
+    _subscription = CameraAuroraPlatform.instance
+        .onChangeState(widget.cameraId)
+        .listen((event) {
       if (mounted) {
         setState(() {
           _cameraState = event;
@@ -37,7 +45,8 @@ class _CameraViewfinderState extends State<CameraViewfinder> {
 
   @override
   void dispose() {
-    CameraAuroraPlatform.instance.stopCapture();
+    _subscription?.cancel();
+    CameraAuroraPlatform.instance.stopCapture(widget.cameraId);
     super.dispose();
   }
 
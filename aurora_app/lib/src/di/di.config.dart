@@ -17,8 +17,9 @@ import '../features/camera/manager.dart' as _i4;
 import '../features/log/log.dart' as _i6;
 import '../features/log/logger.dart' as _i7;
 import '../routes/app_router/app_router.dart' as _i3;
-import '../services/test_check.dart' as _i9;
-import 'di.dart' as _i10;
+import '../services/capture_timeline.dart' as _i9;
+import '../services/test_check.dart' as _i10;
+import 'di.dart' as _i11;
 
 extension GetItInjectableX on _i1.GetIt {
 // initializes the registration of main-scope dependencies inside of GetIt
@@ -43,10 +44,14 @@ extension GetItInjectableX on _i1.GetIt {
       () => appModule.testPhotoCheckClient(gh<_i6.Log>()),
       instanceName: 'TestCheckClient',
     );
-    gh.singleton<_i9.TestCheckService>(() =>
-        _i9.TestCheckService(gh<_i8.Dio>(instanceName: 'TestCheckClient')));
+    gh.singleton<_i9.CaptureTimelines>(
+        () => _i9.CaptureTimelines(gh<_i6.Log>()));
+    gh.singleton<_i10.TestCheckService>(() => _i10.TestCheckService(
+          gh<_i8.Dio>(instanceName: 'TestCheckClient'),
+          gh<_i9.CaptureTimelines>(),
+        ));
     return this;
   }
 }
 
-class _$AppModule extends _i10.AppModule {}
+class _$AppModule extends _i11.AppModule {}
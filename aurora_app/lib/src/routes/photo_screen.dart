@@ -3,6 +3,7 @@ import 'dart:async';
 import 'package:aurora_photo_test/src/features/extensions/uint8list.dart';
 import 'package:auto_route/auto_route.dart';
 import 'package:camera/camera.dart';
+import 'package:camera_aurora/camera_aurora.dart';
 import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
 import 'package:flutter_riverpod/flutter_riverpod.dart';
@@ -19,6 +20,7 @@ import '../features/log/log.dart';
 import '../features/photo_check/notifier.dart';
 import 'package:topg/topg.dart';
 import '../models/device_camera_model.dart';
+import '../services/capture_timeline.dart';
 import 'app_router/app_router.dart';
 
 @RoutePage()
@@ -224,6 +226,7 @@ class _PhotoScreenState extends ConsumerState<PhotoScreen>
 
   Future<void> onTakePictureButtonPressed(
       BuildContext context, PhotoCheckNotifier photoCheckNotifier) async {
+    final tap = DateTime.now();
     await takePicture().then(
       (XFile? xfile) async {
         if (mounted) {
@@ -237,6 +240,7 @@ class _PhotoScreenState extends ConsumerState<PhotoScreen>
             // Save to file
             final file = await bytes.writeToFile(directory![0], xfile);
             getIt.get<Log>().d(file.path);
+            _trackCapture(xfile, file.path, tap);
             photoCheckNotifier.checkPhoto(file.path);
             final camerasManager = getIt.get<CamerasManager>();
             camerasManager.turnOff();
@@ -247,6 +251,18 @@ class _PhotoScreenState extends ConsumerState<PhotoScreen>
     );
   }
 
+  // Native stage times are known for Aurora OS captures only
+  void _trackCapture(XFile xfile, String path, DateTime tap) {
+    final timings = CameraAurora().captureTimings(xfile.name);
+    final timeline = CaptureTimeline(
+      timings?.captureId ?? 0,
+      timings?.toJson(),
+    )
+      ..mark('tap', tap)
+      ..mark('saved');
+    getIt.get<CaptureTimelines>().add(path, timeline);
+  }
+
   Future<XFile?> takePicture() async {
     final CameraController? cameraController = controller;
     if (cameraController == null || !cameraController.value.isInitialized) {
@@ -0,0 +1,65 @@
+import 'package:injectable/injectable.dart';
+
+import '../features/log/log.dart';
+
+/// Stage times of one captured sheet, microseconds since the epoch.
+///
+/// Native stages come from the camera plugin, the app adds `tap`, `saved`,
+/// `upload` and `response`. The backend logs its own stages against
+/// [captureId].
+class CaptureTimeline {
+  CaptureTimeline(this.captureId, [Map<String, int>? stages])
+      : stages = {...?stages};
+
+  final int captureId;
+  final Map<String, int> stages;
+
+  void mark(String stage, [DateTime? time]) =>
+      stages[stage] = (time ?? DateTime.now()).microsecondsSinceEpoch;
+
+  /// Time spent reaching each stage from the previous one.
+  String report() {
+    final ordered = stages.entries.toList()
+      ..sort((a, b) => a.value.compareTo(b.value));
+    if (ordered.isEmpty) {
+      return 'capture $captureId: no stages';
+    }
+    final parts = <String>[];
+    for (var i = 1; i < ordered.length; i++) {
+      final ms = (ordered[i].value - ordered[i - 1].value) / 1000;
+      parts.add('${ordered[i].key} +${ms.toStringAsFixed(0)} ms');
+    }
+    final total = (ordered.last.value - ordered.first.value) / 1000;
+    return 'capture $captureId: ${parts.join(', ')}; '
+        'total ${total.toStringAsFixed(0)} ms';
+  }
+}
+
+/// Timelines of the latest captures by the path of the saved photo.
+@singleton
+class CaptureTimelines {
+  CaptureTimelines(this._log);
+
+  final Log _log;
+  final Map<String, CaptureTimeline> _timelines = {};
+
+  static const _limit = 16;
+
+  CaptureTimeline? operator [](String path) => _timelines[path];
+
+  void add(String path, CaptureTimeline timeline) {
+    _timelines.remove(path);
+    _timelines[path] = timeline;
+    while (_timelines.length > _limit) {
+      _timelines.remove(_timelines.keys.first);
+    }
+  }
+
+  /// Logs the breakdown of the capture saved at [path] and forgets it.
+  void finish(String path) {
+    final timeline = _timelines.remove(path);
+    if (timeline != null) {
+      _log.i(timeline.report());
+    }
+  }
+}
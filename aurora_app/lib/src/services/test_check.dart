@@ -1,15 +1,19 @@
+import 'dart:convert';
+
 import 'package:dio/dio.dart';
 import 'package:injectable/injectable.dart';
 
 import '../clients/test_check_client.dart';
 import '../models/test_results_model.dart';
 import '../models/test_update_model.dart';
+import 'capture_timeline.dart';
 
 @singleton
 class TestCheckService {
   final Dio _client;
+  final CaptureTimelines _timelines;
 
-  const TestCheckService(@testCheckClient this._client);
+  const TestCheckService(@testCheckClient this._client, this._timelines);
 
   Future<TestResultsModel> sendPhoto({
     required String path,
@@ -17,6 +21,8 @@ class TestCheckService {
   }) async {
     final testNumber = int.parse(testId);
     final fileName = path.split('/').last;
+    // The backend logs its stage times against the capture ID
+    final timeline = _timelines[path]?..mark('upload');
     final data = FormData.fromMap({
       'photo': [
         await MultipartFile.fromFile(
@@ -24,6 +30,7 @@ class TestCheckService {
           filename: fileName,
         )
       ],
+      if (timeline != null) 'timings': jsonEncode(timeline.stages),
     });
 
     Response<dynamic> response;
@@ -32,16 +39,20 @@ class TestCheckService {
         '/upload',
         queryParameters: {
           'test_number': testNumber,
+          if (timeline != null) 'capture_id': timeline.captureId,
         },
         data: data,
       );
       // ignore: avoid_catches_without_on_clauses
     } catch (e) {
+      _timelines.finish(path);
       return const TestResultsModel.error(
         message:
             "Oops. It seems the photo didn't turn out very well. Try to take a photo:)",
       );
     }
+    timeline?.mark('response');
+    _timelines.finish(path);
     final responseData = response.data as Map<String, dynamic>;
     responseData['runtimeType'] = 'results';
     return TestResultsModel.fromJson(response.data as Map<String, dynamic>);
@@ -0,0 +1,74 @@
+"""
+Break down where the time goes for every captured sheet.
+
+Reads the JSON lines written by main.py (LATENCY_LOG, latency.jsonl by
+default) and prints the time spent reaching each stage from the previous
+one, then the median and p95 of every step over all the captures.
+
+The app and the server clocks are not synchronized: the step from the
+app "upload" to the server "received" includes the clock offset of the
+device and is marked with "~".
+
+    python latency_report.py [latency.jsonl]
+"""
+import json
+import os
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                yield json.loads(line)
+
+
+def steps(record):
+    client = sorted(record.get("client", {}).items(), key=lambda item: item[1])
+    server = sorted(record.get("server", {}).items(), key=lambda item: item[1])
+
+    # Server stages follow the app ones whatever the clocks say
+    result = []
+    ordered = [(name, time, "app") for name, time in client] + \
+              [("server." + name, time, "server") for name, time in server]
+    for (prev, start, side), (name, end, next_side) in zip(ordered, ordered[1:]):
+        result.append((f"{prev} -> {name}", (end - start) / 1000, side != next_side))
+    return result
+
+
+def percentile(values, q):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(q * len(values)))]
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else os.environ.get("LATENCY_LOG", "latency.jsonl")
+
+    totals = {}
+    order = []
+    for record in load(path):
+        print(f"capture {record.get('capture_id')}")
+        total = 0.0
+        for name, ms, skewed in steps(record):
+            total += ms
+            print(f"  {name:<34}{'~' if skewed else ' '}{ms:9.1f} ms")
+            if name not in totals:
+                totals[name] = []
+                order.append(name)
+            totals[name].append(ms)
+        print(f"  {'total':<34} {total:9.1f} ms")
+
+    if not order:
+        print("no captures")
+        return
+
+    print()
+    print(f"{'step':<36}{'count':>6}{'p50 ms':>10}{'p95 ms':>10}")
+    for name in order:
+        values = totals[name]
+        print(f"{name:<36}{len(values):>6}{percentile(values, 0.5):>10.1f}{percentile(values, 0.95):>10.1f}")
+
+
+if __name__ == '__main__':
+    main()
@@ -1,6 +1,9 @@
 import sys
 import os
-from fastapi import FastAPI, UploadFile, File, Request, HTTPException, Query, status
+import json
+import time
+import logging
+from fastapi import FastAPI, UploadFile, File, Form, Request, HTTPException, Query, status
 import uvicorn
 import asyncio
 from aurora_cv import get_answer
@@ -16,12 +19,47 @@ tests: dict = {}
 if "USERS" in os.environ:
     users.update({k: v for k, v in [pair.split(":") for pair in os.environ["USERS"].split(",")]})
 
+# One JSON line per captured sheet, see latency_report.py
+latency_log = os.environ.get("LATENCY_LOG", "latency.jsonl")
+logger = logging.getLogger("uvicorn.error")
+
+
+def now_us():
+    return int(time.time() * 1_000_000)
+
+
+def log_latency(capture_id, timings, stages):
+    """
+    Append the stage times of the app and of the server for one capture,
+    microseconds since the epoch.
+    """
+    try:
+        client = json.loads(timings) if timings else {}
+    except ValueError:
+        client = {}
+
+    record = {"capture_id": capture_id, "client": client, "server": stages}
+    try:
+        with open(latency_log, "a") as f:
+            f.write(json.dumps(record) + "\n")
+    except OSError as e:
+        logger.warning("latency log: %s", e)
+
+    logger.info("capture %s: save %.0f ms, grade %.0f ms",
+                capture_id,
+                (stages["saved"] - stages["received"]) / 1000,
+                (stages["graded"] - stages["saved"]) / 1000)
+
 
 @app.post("/upload")
-async def upload_photo(test_number: int = Query(None), photo: UploadFile = File(...)):
+async def upload_photo(test_number: int = Query(None), photo: UploadFile = File(...),
+                       capture_id: str = Query(None), timings: str = Form(None)):
     """
     :param test_number: query param, integer
     :param photo: uploaded photo
+    :param capture_id: optional query param, capture ID of the app
+    :param timings: optional form field, JSON of the app stage times in µs;
+        with capture_id the server stage times are logged to LATENCY_LOG
     :return:
         Test results info:
             1) Answers: (question, your answer, correct answer
@@ -46,6 +84,8 @@ async def upload_photo(test_number: int = Query(None), photo: UploadFile = File(
             "test_number": 1
         }
     """
+    stages = {"received": now_us()}
+
     if test_number is None:
         raise HTTPException(status_code=status.HTTP_400_BAD_REQUEST, detail="invalid query parameter")
 
@@ -58,12 +98,14 @@ async def upload_photo(test_number: int = Query(None), photo: UploadFile = File(
 
     with open(os.path.join(photos_dir, photo.filename), "wb") as f:
         f.write(photo.file.read())
+    stages["saved"] = now_us()
 
     correct_answers = [{"question": str(i), "correct_answer": answer} for i, answer in tests[test_number].items()]
     try:
         answer = get_answer(os.path.join(photos_dir, photo.filename), correct_answers)
     except ValueError as e:
         raise HTTPException(status_code=status.HTTP_500_INTERNAL_SERVER_ERROR, detail=f"image processing error: {e}")
+    stages["graded"] = now_us()
 
     if answer is None:
         raise HTTPException(status_code=status.HTTP_400_BAD_REQUEST, detail="invalid photo format")
@@ -78,6 +120,10 @@ async def upload_photo(test_number: int = Query(None), photo: UploadFile = File(
         "test_number": test_number
     }
 
+    if capture_id is not None:
+        stages["responded"] = now_us()
+        log_latency(capture_id, timings, stages)
+
     return result
 
 